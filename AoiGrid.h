@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// ===== 관심 영역(AOI) 균일 격자 =====
+// 방 좌표 범위를 시야 반경 크기의 칸으로 나누고, 틱마다 슬롯 위치로 다시 채운다 (카운팅 정렬, O(N)).
+// 반경 r 조회는 주변 3x3 칸만 확인한다.
+class AoiGrid
+{
+public:
+    // 범위 밖 좌표는 가장자리 칸으로 들어감
+    void Configure(float min_x, float min_y, float max_x, float max_y, float cell_size)
+    {
+        min_x_ = min_x;
+        min_y_ = min_y;
+        cell_size_ = cell_size > 0.0f ? cell_size : 1.0f;
+        cols_ = CellCount(max_x - min_x);
+        rows_ = CellCount(max_y - min_y);
+        cell_start_.assign(static_cast<std::size_t>(cols_) * rows_ + 1, 0);
+    }
+
+    // ids[slot] == 0인 빈 슬롯은 제외
+    void Rebuild(const std::uint32_t* ids, const float* xs, const float* ys, std::uint16_t count)
+    {
+        slot_cell_.resize(count);
+        cell_slots_.resize(count);
+        std::fill(cell_start_.begin(), cell_start_.end(), 0);
+
+        for (std::uint16_t slot = 0; slot < count; ++slot)
+        {
+            if (ids[slot] == 0)
+                continue;
+            slot_cell_[slot] = CellIndex(CellX(xs[slot]), CellY(ys[slot]));
+            ++cell_start_[slot_cell_[slot] + 1];
+        }
+
+        for (std::size_t i = 1; i < cell_start_.size(); ++i)
+            cell_start_[i] += cell_start_[i - 1];
+
+        // cell_start_[c]는 다음에 쓸 위치로 쓰고, 채운 뒤 한 칸씩 밀어서 복구
+        for (std::uint16_t slot = 0; slot < count; ++slot)
+        {
+            if (ids[slot] != 0)
+                cell_slots_[cell_start_[slot_cell_[slot]]++] = slot;
+        }
+        for (std::size_t i = cell_start_.size() - 1; i > 0; --i)
+            cell_start_[i] = cell_start_[i - 1];
+        cell_start_[0] = 0;
+    }
+
+    // (x, y)에서 반경 안에 있을 수 있는 슬롯 후보 순회 (거리 판정은 호출 쪽에서)
+    // 칸 크기가 시야 반경 이상이므로 주변 3x3 칸이면 충분
+    template <typename Fn>
+    void ForEachNear(float x, float y, Fn&& fn) const
+    {
+        const int cx = CellX(x);
+        const int cy = CellY(y);
+        for (int gy = std::max(cy - 1, 0); gy <= std::min(cy + 1, rows_ - 1); ++gy)
+        {
+            for (int gx = std::max(cx - 1, 0); gx <= std::min(cx + 1, cols_ - 1); ++gx)
+            {
+                const std::size_t cell = CellIndex(gx, gy);
+                for (std::uint32_t i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i)
+                    fn(cell_slots_[i]);
+            }
+        }
+    }
+
+private:
+    static constexpr int MAX_CELLS_PER_AXIS = 256;
+
+    int CellCount(float extent) const
+    {
+        return ClampCell(extent / cell_size_, MAX_CELLS_PER_AXIS - 1) + 1;
+    }
+
+    // float 칸 좌표 -> [0, last] 정수 칸
+    // NaN/무한대/int 범위 밖 값을 그대로 int로 바꾸면 UB이므로 float에서 먼저 범위를 맞춘 뒤 변환 (NaN은 0번 칸)
+    static int ClampCell(float cell, int last)
+    {
+        if (!std::isfinite(cell))
+            return cell > 0.0f ? last : 0;
+        if (cell <= 0.0f)
+            return 0;
+        if (cell >= static_cast<float>(last))
+            return last;
+        return static_cast<int>(cell);
+    }
+
+    int CellX(float x) const { return ClampCell((x - min_x_) / cell_size_, cols_ - 1); }
+    int CellY(float y) const { return ClampCell((y - min_y_) / cell_size_, rows_ - 1); }
+    std::size_t CellIndex(int cx, int cy) const { return static_cast<std::size_t>(cy) * cols_ + cx; }
+
+    float min_x_ = 0.0f;
+    float min_y_ = 0.0f;
+    float cell_size_ = 1.0f;
+    int cols_ = 1;
+    int rows_ = 1;
+    std::vector<std::uint32_t> cell_start_; // 칸별 시작 위치 (cells + 1개)
+    std::vector<std::uint16_t> cell_slots_; // 칸 순서로 정렬한 슬롯 번호
+    std::vector<std::size_t> slot_cell_;
+};
@@ -0,0 +1,139 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ===== 비트 단위 직렬화 (압축 상태 패킷용) =====
+
+// LSB부터 채우는 비트 writer (버퍼는 0으로 초기화되어 있어야 함)
+class BitWriter
+{
+public:
+    BitWriter(std::uint8_t* data, std::size_t capacity)
+        : data_(data), capacity_bits_(capacity * 8)
+    {
+    }
+
+    bool Write(std::uint32_t value, unsigned int bits)
+    {
+        if (bit_pos_ + bits > capacity_bits_)
+            return false;
+
+        for (unsigned int i = 0; i < bits; ++i, ++bit_pos_)
+        {
+            if ((value >> i) & 1u)
+                data_[bit_pos_ >> 3] |= static_cast<std::uint8_t>(1u << (bit_pos_ & 7));
+        }
+        return true;
+    }
+
+    std::size_t BytesWritten() const { return (bit_pos_ + 7) / 8; }
+    std::size_t BitsRemaining() const { return capacity_bits_ - bit_pos_; }
+
+private:
+    std::uint8_t* data_;
+    std::size_t capacity_bits_;
+    std::size_t bit_pos_ = 0;
+};
+
+class BitReader
+{
+public:
+    BitReader(const std::uint8_t* data, std::size_t size)
+        : data_(data), size_bits_(size * 8)
+    {
+    }
+
+    bool Read(std::uint32_t& value, unsigned int bits)
+    {
+        if (bit_pos_ + bits > size_bits_)
+            return false;
+
+        value = 0;
+        for (unsigned int i = 0; i < bits; ++i, ++bit_pos_)
+        {
+            if ((data_[bit_pos_ >> 3] >> (bit_pos_ & 7)) & 1u)
+                value |= 1u << i;
+        }
+        return true;
+    }
+
+private:
+    const std::uint8_t* data_;
+    std::size_t size_bits_;
+    std::size_t bit_pos_ = 0;
+};
+
+// ===== 좌표 양자화 =====
+
+// 방 좌표 범위와 정밀도 (압축 포맷 클라이언트에게 NOTICE_ROOM_LAYOUT으로 전달)
+struct QuantizationParams
+{
+    float min_x = -1024.0f;
+    float min_y = -1024.0f;
+    float max_x = 1024.0f;
+    float max_y = 1024.0f;
+    std::uint8_t position_bits = 14; // 축당 비트 수 (2048 범위 / 2^14 = 0.125 단위)
+    std::uint8_t slot_bits = 4;      // 방 내부 슬롯 번호 비트 수 (방 정원에서 계산)
+};
+
+// 범위 밖 값은 경계로 잘림
+constexpr std::uint32_t QuantizeCoord(float value, float min, float max, unsigned int bits)
+{
+    const std::uint32_t steps = (1u << bits) - 1;
+    if (!(value > min))
+        return 0;
+    if (value >= max)
+        return steps;
+
+    return static_cast<std::uint32_t>((value - min) / (max - min) * static_cast<float>(steps) + 0.5f);
+}
+
+constexpr float DequantizeCoord(std::uint32_t quantized, float min, float max, unsigned int bits)
+{
+    const std::uint32_t steps = (1u << bits) - 1;
+    return min + static_cast<float>(quantized) * (max - min) / static_cast<float>(steps);
+}
+
+// 왕복 오차 상한 = 한 단계의 절반
+constexpr float QuantizationMaxError(float min, float max, unsigned int bits)
+{
+    return (max - min) / static_cast<float>((1u << bits) - 1) * 0.5f;
+}
+
+// 정원 n명을 구분하는 데 필요한 슬롯 비트 수
+constexpr std::uint8_t SlotBitsForCapacity(std::uint32_t capacity)
+{
+    std::uint8_t bits = 1;
+    while (bits < 16 && (1u << bits) < capacity)
+        ++bits;
+    return bits;
+}
+
+namespace bit_packing_check
+{
+    constexpr float Abs(float v) { return v < 0.0f ? -v : v; }
+
+    constexpr bool RoundTripWithinBound(float value)
+    {
+        constexpr QuantizationParams params{};
+        const float restored = DequantizeCoord(
+            QuantizeCoord(value, params.min_x, params.max_x, params.position_bits),
+            params.min_x, params.max_x, params.position_bits);
+
+        // float 연산 오차 여유 1%
+        return Abs(restored - value) <=
+            QuantizationMaxError(params.min_x, params.max_x, params.position_bits) * 1.01f;
+    }
+
+    static_assert(RoundTripWithinBound(0.0f), "quantization round trip");
+    static_assert(RoundTripWithinBound(1.5f), "quantization round trip");
+    static_assert(RoundTripWithinBound(-1023.9f), "quantization round trip");
+    static_assert(RoundTripWithinBound(1023.937f), "quantization round trip");
+    static_assert(RoundTripWithinBound(-1024.0f), "quantization round trip");
+    static_assert(RoundTripWithinBound(1024.0f), "quantization round trip");
+    static_assert(RoundTripWithinBound(333.333f), "quantization round trip");
+    static_assert(SlotBitsForCapacity(16) == 4, "16 slots fit in 4 bits");
+    static_assert(SlotBitsForCapacity(100) == 7, "100 slots fit in 7 bits");
+    static_assert(SlotBitsForCapacity(4) == 2, "4 slots fit in 2 bits");
+}
@@ -1,18 +1,33 @@
-﻿#include <iostream>
-#include <boost/asio.hpp>
+﻿#include <boost/asio.hpp>
 
 #include "GameServer.h"
+#include "IoContextPool.h"
+#include "ServerConfig.h"
+#include "Logger.h"
 
-int main()
+int main(int argc, char* argv[])
 {
-    boost::asio::io_context io_context;
+    ServerConfig config = ServerConfig::FromArgs(argc, argv);
+    Logger::Instance().SetMinLevel(config.log_level);
 
-    GameServer gameServer(io_context);
+    IoContextPool io_pool(config.ResolveIoThreadCount(), config.pin_io_threads);
+
+    GameServer gameServer(io_pool, config);
     gameServer.Start();
 
-    io_context.run();
+    // Ctrl+C / kill이면 Stop으로 정리 (통계도 이때 마지막으로 남김) -> io_pool.Run()이 돌아옴
+    boost::asio::signal_set signals(io_pool.GetIoContext(0), SIGINT, SIGTERM);
+    signals.async_wait([&gameServer](const boost::system::error_code& ec, int signal_number)
+        {
+            if (ec)
+                return;
+
+            LOG_INFO("Received signal %d", signal_number);
+            gameServer.Stop();
+        });
+
+    io_pool.Run();
 
-    std::cout << "메인 서버를 종료하려면 키를 누르세요... " << std::endl;
-    getchar();
+    Logger::Instance().Shutdown();
     return 0;
 }
@@ -1,12 +1,12 @@
 ﻿#pragma once
 
-#include <iostream>
 #include <vector>
 #include <deque>
 #include <algorithm>
 #include <string>
 #include <memory>
 #include <cstdio>
+#include <cmath>
 #include <boost/asio.hpp>
 
 #include "Session.h"
@@ -15,41 +15,97 @@
 #include "UserManager.h"
 #include "RoomManager.h"
 #include "PacketHandler.h"
+#include "IoContextPool.h"
+#include "TickScheduler.h"
+#include "ServerConfig.h"
+#include "SendQueuePolicy.h"
+#include "UdpChannel.h"
+#include "Logger.h"
 
 using boost::asio::ip::tcp;
 
 class GameServer
 {
 public:
-    GameServer(boost::asio::io_context& io_context)
-        : io_context_(io_context),
-        acceptor_(io_context, tcp::endpoint(tcp::v4(), PORT_NUMBER)),
-        room_manager_(io_context)
+    GameServer(IoContextPool& io_pool, const ServerConfig& config)
+        : io_pool_(io_pool),
+        config_(config),
+        acceptor_(io_pool.GetIoContext(0), tcp::endpoint(tcp::v4(), config.port)),
+        stats_timer_(io_pool.GetIoContext(0)),
+        session_manager_(io_pool),
+        user_manager_(io_pool),
+        tick_scheduler_(io_pool, config.room_tick),
+        room_manager_(io_pool, tick_scheduler_, session_manager_.GetHandles(), config),
+        packet_dispatcher_(*this)
     {
-        InitializeMessageHandlers();
+        tick_scheduler_.Start();
 
-        // 기본 방 몇 개 생성 (원하면 이름만 바꿔도 됨)
-        room_manager_.CreateRoom("Lobby", 100);
-        room_manager_.CreateRoom("Room1", 4);
+        // 기본 방 몇 개 생성 (원하면 이름만 바꿔도 됨), 비어도 제거되지 않도록 고정
+        room_manager_.CreateRoom("Lobby", 100, true);
+        room_manager_.CreateRoom("Room1", 4, true);
+        room_manager_.StartReaper();
+
+        // 상태 전용 UDP 채널 (선택): 소켓은 샤드 하나가 전담
+        if (config.udp_enabled)
+        {
+            udp_channel_ = std::make_unique<UdpChannel>(io_pool.GetNextIoContext(), UDP_PORT_NUMBER,
+                session_manager_.GetHandles(), packet_dispatcher_);
+            udp_channel_->Start();
+        }
 
         StartAccept();
+
+        if (config.stats_report_interval.count() > 0)
+            boost::asio::post(stats_timer_.get_executor(), [this]() { ScheduleStatsReport(); });
+    }
+
+    // Stop 후 io_pool.Run()이 끝난 다음 파괴: 틱 타이머/UDP 소켓의 취소된 작업이 멤버 안의 핸들러 메모리를 쓰고 있으므로 먼저 마저 끝낸다
+    ~GameServer()
+    {
+        io_pool_.Drain();
     }
 
     void Start()
     {
-        std::cout << "Game server started on port "
-            << acceptor_.local_endpoint().port() << std::endl;
+        LOG_INFO("Game server started on port %u (I/O threads: %zu, backend: %s)",
+            static_cast<unsigned int>(GetPort()), io_pool_.Size(), IoContextPool::BackendName());
+        if (udp_channel_)
+            LOG_INFO("UDP state channel on port %u", static_cast<unsigned int>(udp_channel_->GetPort()));
     }
 
     void Stop()
     {
-        std::cout << "Stopping game server..." << std::endl;
-        acceptor_.close();
+        LOG_INFO("Stopping game server...");
+
+        // acceptor는 샤드 0의 accept 핸들러와 같은 쓰레드에서 닫는다 (여기까지 못 돌면 ~GameServer의 Drain에서)
+        boost::asio::post(acceptor_.get_executor(), [this]()
+            {
+                boost::system::error_code ec;
+                acceptor_.close(ec);
+            });
+        if (udp_channel_)
+            udp_channel_->Close();
         session_manager_.DisconnectAll();
+        room_manager_.StopReaper();
+        stats_stopped_ = true;
+        boost::asio::post(stats_timer_.get_executor(), [this]() { stats_timer_.cancel(); });
+        tick_scheduler_.Stop();
+        io_pool_.Stop();
+
+        ReportStats();
+    }
+
+    // 누적 통계 로그 (아무 쓰레드, 값은 모두 atomic)
+    void ReportStats() const
+    {
+        send_queue_stats_.Report();
+        tick_scheduler_.GetStats().Report();
+        if (udp_channel_)
+            udp_channel_->GetStats().Report();
     }
 
     // ===== 패킷 처리들 =====
-    void ProcessLogin(std::shared_ptr<Session> session, const PKT_REQ_LOGIN& request)
+    void ProcessLogin(Session& session, const PKT_REQ_LOGIN& request)
     {
         PKT_RES_LOGIN response{};
         response.pkt_id = RES_LOGIN;
@@ -61,15 +117,24 @@ public:
             if (user)
             {
                 user->SetOnline(true);
-                user->SetSession(session);
+                user->SetSessionHandle(session.GetHandle());
 
-                session->SetUserId(user->GetId());
-                session->SetAuthenticated(true);
+                session.SetUserId(user->GetId());
+                session.SetUserHandle(user->GetHandle());
+                session.SetAuthenticated(true);
+                session_manager_.BindUser(user->GetId(), session.shared_from_this());
 
-                response.userId = session->GetUserId();
+                // 압축 상태 포맷 요청 시 수락 (그 외 값은 기본 포맷)
+                const WIRE_FORMAT format = request.wireFormat == WIRE_FORMAT_COMPACT
+                    ? WIRE_FORMAT_COMPACT : WIRE_FORMAT_DEFAULT;
+                session.SetWireFormat(format);
+
+                response.userId = session.GetUserId();
                 response.isSuccess = true;
-                std::cout << "User logged in: " << request.userId
-                    << " (ID: " << user->GetId() << ")" << std::endl;
+                response.wireFormat = format;
+                if (udp_channel_)
+                    response.udpToken = udp_channel_->IssueToken(session);
+                LOG_INFO("User logged in: %s (ID: %u)", user->GetUsername().c_str(), user->GetId());
             }
             else
             {
@@ -82,112 +147,135 @@ public:
             response.isSuccess = false;
         }
 
-        session->SendMessage(&response, sizeof(response));
+        session.SendMessage(&response, sizeof(response));
     }
 
-    void ProcessLogout(std::shared_ptr<Session> session, const PKT_REQ_LOGOUT& request)
+    void ProcessLogout(Session& session, const PKT_REQ_LOGOUT& request)
     {
         PKT_RES_LOGOUT response{};
         response.pkt_id = RES_LOGOUT;
         response.pkt_size = sizeof(PKT_RES_LOGOUT);
         response.isSuccess = false;
 
-        if (!session->IsAuthenticated())
+        if (!session.IsAuthenticated())
         {
-            session->SendMessage(&response, sizeof(response));
+            session.SendMessage(&response, sizeof(response));
             return;
         }
 
-        uint32_t user_id = session->GetUserId();
+        uint32_t user_id = session.GetUserId();
         auto user = user_manager_.GetUser(user_id);
         if (user)
         {
-            // 모든 방에서 제거
-            auto rooms = room_manager_.GetRoomList();
-            for (auto& room : rooms)
-            {
-                room->RemoveUser(user_id);
-            }
+            // 입장해 있는 방에서만 제거
+            user->ForEachRoom([user_id](Room& room) { room.QueueDeparture(user_id); });
 
             user->SetOnline(false);
-            session->SetAuthenticated(false);
+            user->SetSessionHandle(SlotMap<Session>::INVALID_HANDLE);
+            session.SetAuthenticated(false);
+            session.SetUdpSecret(0);
+            session.SetUdpBound(false);
+            session_manager_.UnbindUser(user_id, session);
             response.isSuccess = true;
 
-            std::cout << "User logout: " << user->GetUsername()
-                << " (ID: " << user_id << ")" << std::endl;
+            LOG_INFO("User logout: %s (ID: %u)", user->GetUsername().c_str(), user_id);
         }
 
-        session->SendMessage(&response, sizeof(response));
+        session.SendMessage(&response, sizeof(response));
     }
 
-    void ProcessChatMessage(std::shared_ptr<Session> session, const PKT_REQ_CHAT& message)
+    void ProcessChatMessage(Session& session, const PKT_REQ_CHAT& message)
     {
-        if (!session->IsAuthenticated())
+        if (!session.IsAuthenticated())
             return;
 
-        auto user = user_manager_.GetUser(session->GetUserId());
+        User* user = user_manager_.Resolve(session.GetUserHandle());
         if (!user)
             return;
 
+        // 채널마다 한 번만 직렬화하고 받는 세션들이 같은 버퍼를 공유
+        const CHAT_CHANNEL channel = static_cast<CHAT_CHANNEL>(message.channel);
         PKT_NOTICE_CHAT notice{};
-        notice.pkt_id = NOTICE_CHAT;
-        notice.pkt_size = sizeof(PKT_NOTICE_CHAT);
+        MakeNoticeChat(notice, channel, user->GetUsername().c_str(), message.message, message.messageLen);
+        auto packet = MakeSendBuffer(&notice, notice.pkt_size);
 
-        std::snprintf(notice.senderName, MAX_NAME_LEN, "%s", user->GetUsername().c_str());
-        std::snprintf(notice.message, MAX_MESSAGE_LEN, "%s", message.message);
+        switch (channel)
+        {
+        case CHAT_CHANNEL_ROOM:
+        {
+            // 방에 없으면 보낼 곳이 없음
+            if (auto room = user->GetCurrentRoom())
+                room->Broadcast(std::move(packet));
+            break;
+        }
+        case CHAT_CHANNEL_GLOBAL:
+            session_manager_.BroadcastToAll(std::move(packet), io_pool_);
+            break;
+        case CHAT_CHANNEL_WHISPER:
+        {
+            const std::string target_name(message.targetName, strnlen(message.targetName, MAX_NAME_LEN));
+            auto target = user_manager_.GetUserByName(target_name);
+            if (!target || !target->IsOnline())
+                break;
 
-        // 일단은 전체 브로드캐스트 (원하면 방 단위로 바꿔도 됨)
-        session_manager_.BroadcastToAll(&notice, sizeof(notice));
+            Session* target_session = session_manager_.GetHandles().Get(target->GetSessionHandle());
+            if (!target_session || !target_session->IsAuthenticated())
+                break;
+
+            target_session->Send(packet);
+            if (target_session != &session)
+                session.Send(std::move(packet));
+            break;
+        }
+        default:
+            break;
+        }
     }
 
-    void ProcessCreateRoom(std::shared_ptr<Session> session, const PKT_REQ_CREATE_ROOM& request)
+    void ProcessCreateRoom(Session& session, const PKT_REQ_CREATE_ROOM& request)
     {
         PKT_RES_CREATE_ROOM response{};
         response.pkt_id = RES_CREATE_ROOM;
         response.pkt_size = sizeof(PKT_RES_CREATE_ROOM);
         response.isSuccess = false;
 
-        if (!session->IsAuthenticated())
+        if (!session.IsAuthenticated())
         {
-            session->SendMessage(&response, sizeof(response));
+            session.SendMessage(&response, sizeof(response));
             return;
         }
 
         std::string roomName(request.roomName);
         if (roomName.empty())
         {
-            session->SendMessage(&response, sizeof(response));
+            session.SendMessage(&response, sizeof(response));
             return;
         }
 
-        auto exist = room_manager_.GetRoomByName(roomName);
-        if (exist)
+        if (!room_manager_.CreateRoom(roomName, 4))
         {
             // 이미 존재
-            session->SendMessage(&response, sizeof(response));
+            session.SendMessage(&response, sizeof(response));
             return;
         }
 
-        room_manager_.CreateRoom(roomName, 4);
         response.isSuccess = true;
 
-        std::cout << "Room created by user "
-            << session->GetUserId()
-            << ": " << roomName << std::endl;
+        LOG_INFO("Room created by user %u: %s", session.GetUserId(), roomName.c_str());
 
-        session->SendMessage(&response, sizeof(response));
+        session.SendMessage(&response, sizeof(response));
     }
 
-    void ProcessEnterRoom(std::shared_ptr<Session> session, const PKT_REQ_ENTER_ROOM& request)
+    void ProcessEnterRoom(Session& session, const PKT_REQ_ENTER_ROOM& request)
     {
         PKT_RES_ENTER_ROOM response{};
         response.pkt_id = RES_ENTER_ROOM;
         response.pkt_size = sizeof(PKT_RES_ENTER_ROOM);
         response.isSuccess = false;
 
-        if (!session->IsAuthenticated())
+        if (!session.IsAuthenticated())
         {
-            session->SendMessage(&response, sizeof(response));
+            session.SendMessage(&response, sizeof(response));
             return;
         }
 
@@ -197,48 +285,42 @@ public:
         auto room = room_manager_.GetRoomByName(roomName);
         if (!room)
         {
-            session->SendMessage(&response, sizeof(response));
+            session.SendMessage(&response, sizeof(response));
             return;
         }
 
         //std::cout << "GetRoomByName" << std::endl;
 
-        auto user = user_manager_.GetUser(session->GetUserId());
+        auto user = user_manager_.GetUser(session.GetUserId());
         if (!user)
         {
-            session->SendMessage(&response, sizeof(response));
+            session.SendMessage(&response, sizeof(response));
             return;
         }
 
         //std::cout << "GetUser" << std::endl;
 
-        if (room->AddUser(user))
-        {
-            response.isSuccess = true;
-
-            // 방 정보 알림 (옵션)
-            PKT_NOTICE_ROOM_INFO notice{};
-            notice.pkt_id = NOTICE_ROOM_INFO;
-            notice.pkt_size = sizeof(PKT_NOTICE_ROOM_INFO);
-            std::snprintf(notice.roomName, MAX_ROOM_NAME_LEN, "%s", roomName.c_str());
-            notice.playerCount = static_cast<std::uint16_t>(room->GetUserCount());
-
-            room->BroadcastMessage(NOTICE_ROOM_INFO, &notice, sizeof(notice));
-        }
-
-        session->SendMessage(&response, sizeof(response));
+        // 입장은 방 strand에서 처리되고, 응답은 완료 콜백에서 전송
+        room->AddUser(user, [session = session.shared_from_this()](bool added)
+            {
+                PKT_RES_ENTER_ROOM response{};
+                response.pkt_id = RES_ENTER_ROOM;
+                response.pkt_size = sizeof(PKT_RES_ENTER_ROOM);
+                response.isSuccess = added;
+                session->SendMessage(&response, sizeof(response));
+            });
     }
 
-    void ProcessLeaveRoom(std::shared_ptr<Session> session, const PKT_REQ_LEAVE_ROOM& request)
+    void ProcessLeaveRoom(Session& session, const PKT_REQ_LEAVE_ROOM& request)
     {
         PKT_RES_LEAVE_ROOM response{};
         response.pkt_id = RES_LEAVE_ROOM;
         response.pkt_size = sizeof(PKT_RES_LEAVE_ROOM);
         response.isSuccess = false;
 
-        if (!session->IsAuthenticated())
+        if (!session.IsAuthenticated())
         {
-            session->SendMessage(&response, sizeof(response));
+            session.SendMessage(&response, sizeof(response));
             return;
         }
 
@@ -246,28 +328,21 @@ public:
         auto room = room_manager_.GetRoomByName(roomName);
         if (!room)
         {
-            session->SendMessage(&response, sizeof(response));
+            session.SendMessage(&response, sizeof(response));
             return;
         }
 
-        uint32_t user_id = session->GetUserId();
-        if (room->RemoveUser(user_id))
-        {
-            response.isSuccess = true;
-
-            PKT_NOTICE_ROOM_INFO notice{};
-            notice.pkt_id = NOTICE_ROOM_INFO;
-            notice.pkt_size = sizeof(PKT_NOTICE_ROOM_INFO);
-            std::snprintf(notice.roomName, MAX_ROOM_NAME_LEN, "%s", roomName.c_str());
-            notice.playerCount = static_cast<std::uint16_t>(room->GetUserCount());
-
-            room->BroadcastMessage(NOTICE_ROOM_INFO, &notice, sizeof(notice));
-        }
-
-        session->SendMessage(&response, sizeof(response));
+        room->RemoveUser(session.GetUserId(), [session = session.shared_from_this()](bool removed)
+            {
+                PKT_RES_LEAVE_ROOM response{};
+                response.pkt_id = RES_LEAVE_ROOM;
+                response.pkt_size = sizeof(PKT_RES_LEAVE_ROOM);
+                response.isSuccess = removed;
+                session->SendMessage(&response, sizeof(response));
+            });
     }
 
-    void ProcessRoomListRequest(std::shared_ptr<Session> session, const PKT_REQ_ROOM_LIST& /*request*/)
+    void ProcessRoomListRequest(Session& session, const PKT_REQ_ROOM_LIST& /*request*/)
     {
         PKT_RES_ROOM_LIST response{};
         response.pkt_id = RES_ROOM_LIST;
@@ -288,22 +363,44 @@ public:
         }
 
         response.roomCount = count;
-        session->SendMessage(&response, sizeof(response));
+        session.SendMessage(&response, sizeof(response));
+    }
+
+    void ProcessPlayerState(Session& session, const PKT_REQ_PLAYER_STATE& request)
+    {
+        if (!session.IsAuthenticated())
+            return;
+
+        User* user = user_manager_.Resolve(session.GetUserHandle());
+        if (!user)
+            return;
+
+        // NaN/무한대 좌표는 거리 계산/양자화/다른 클라이언트까지 오염시키므로 버림
+        const CharacterState state = request.characterState;
+        if (!std::isfinite(state.pos_x) || !std::isfinite(state.pos_y))
+            return;
+
+        // 상태는 유저가 들어가 있는 방의 슬롯 배열에 기록 (다음 틱에 브로드캐스트)
+        const uint32_t user_id = user->GetId();
+        user->ForEachRoom([user_id, &state](Room& room) { room.UpdatePlayerState(user_id, state); });
     }
 
-    void ProcessPlayerState(std::shared_ptr<Session> session, const PKT_REQ_PLAYER_STATE& request)
+    void ProcessSnapshotAck(Session& session, const PKT_REQ_SNAPSHOT_ACK& request)
     {
-        if (!session->IsAuthenticated())
+        if (!session.IsAuthenticated())
             return;
 
-        auto user = user_manager_.GetUser(session->GetUserId());
+        User* user = user_manager_.Resolve(session.GetUserHandle());
         if (!user)
             return;
 
-        user->SetCharacterState(request.characterState);
+        // 확인 기준은 방마다 따로 (스냅샷을 보낸 방만 받아들인다)
+        const uint32_t user_id = user->GetId();
+        const uint32_t seq = request.snapshotSeq;
+        user->ForEachRoom([user_id, seq](Room& room) { room.AckSnapshot(user_id, seq); });
     }
 
-    void OnSessionDisconnected(std::shared_ptr<Session> session)
+    void OnSessionDisconnected(const std::shared_ptr<Session>& session)
     {
         if (session->IsAuthenticated())
         {
@@ -312,15 +409,12 @@ public:
             if (user)
             {
                 user->SetOnline(false);
+                user->SetSessionHandle(SlotMap<Session>::INVALID_HANDLE);
 
-                auto rooms = room_manager_.GetRoomList();
-                for (auto& room : rooms)
-                {
-                    room->RemoveUser(user_id);
-                }
+                // 입장해 있는 방에서만 제거 (끊김이 몰리면 방마다 묶어서 처리)
+                user->ForEachRoom([user_id](Room& room) { room.QueueDeparture(user_id); });
 
-                std::cout << "User disconnected: " << user->GetUsername()
-                    << " (ID: " << user_id << ")" << std::endl;
+                LOG_INFO("User disconnected: %s (ID: %u)", user->GetUsername().c_str(), user_id);
             }
         }
         session_manager_.RemoveSession(session);
@@ -328,15 +422,46 @@ public:
 
     PacketDispatcher& GetPacketDispatcher() { return packet_dispatcher_; }
 
+    // --udp로 켰을 때만, 아니면 nullptr
+    UdpChannel* GetUdpChannel() { return udp_channel_.get(); }
+
+    const ServerConfig& GetConfig() const { return config_; }
+
+    // 실제로 대기 중인 TCP 포트 (config.port가 0이었으면 OS가 배정한 값)
+    std::uint16_t GetPort() const { return acceptor_.local_endpoint().port(); }
+    SendQueueStats& GetSendQueueStats() { return send_queue_stats_; }
+
 private:
+    // 샤드 0에서 주기적으로 ReportStats (빈 방 정리 타이머와 같은 방식)
+    void ScheduleStatsReport()
+    {
+        if (stats_stopped_)
+            return;
+
+        stats_timer_.expires_after(config_.stats_report_interval);
+        stats_timer_.async_wait([this](const boost::system::error_code& ec)
+            {
+                if (ec)
+                    return;
+
+                ReportStats();
+                ScheduleStatsReport();
+            });
+    }
+
     void StartAccept()
     {
+        // 새 세션은 라운드 로빈으로 I/O 샤드에 배치 (이후 읽기/쓰기는 그 샤드 쓰레드에서만 실행)
         auto new_session = std::make_shared<Session>(
-            tcp::socket(io_context_), *this);
+            tcp::socket(io_pool_.GetNextIoContext()), *this);
 
         acceptor_.async_accept(new_session->GetSocket(),
             [this, new_session](boost::system::error_code ec)
             {
+                // Stop으로 acceptor를 닫았으면 끝 (다시 걸면 바로 실패해서 계속 돈다)
+                if (!acceptor_.is_open())
+                    return;
+
                 if (!ec)
                 {
                     session_manager_.AddSession(new_session);
@@ -346,23 +471,17 @@ private:
             });
     }
 
-    void InitializeMessageHandlers()
-    {
-        packet_dispatcher_.RegisterHandler(REQ_LOGIN, std::make_unique<LoginHandler>(*this));
-        packet_dispatcher_.RegisterHandler(REQ_LOGOUT, std::make_unique<LogoutHandler>(*this));
-        packet_dispatcher_.RegisterHandler(REQ_CHAT, std::make_unique<ChatMessageHandler>(*this));
-        packet_dispatcher_.RegisterHandler(REQ_CREATE_ROOM, std::make_unique<CreateRoomHandler>(*this));
-        packet_dispatcher_.RegisterHandler(REQ_ENTER_ROOM, std::make_unique<EnterRoomHandler>(*this));
-        packet_dispatcher_.RegisterHandler(REQ_LEAVE_ROOM, std::make_unique<LeaveRoomHandler>(*this));
-        packet_dispatcher_.RegisterHandler(REQ_ROOM_LIST, std::make_unique<RoomListHandler>(*this));
-        packet_dispatcher_.RegisterHandler(REQ_PLAYER_STATE, std::make_unique<PlayerStateHandler>(*this));
-    }
-
-    boost::asio::io_context& io_context_;
+    IoContextPool& io_pool_;
+    ServerConfig config_;
+    SendQueueStats send_queue_stats_;
     tcp::acceptor acceptor_;
+    boost::asio::steady_timer stats_timer_;
+    std::atomic<bool> stats_stopped_{ false };
 
     SessionManager session_manager_;
     UserManager    user_manager_;
+    TickScheduler  tick_scheduler_;
     RoomManager    room_manager_;
     PacketDispatcher packet_dispatcher_;
+    std::unique_ptr<UdpChannel> udp_channel_;
 };
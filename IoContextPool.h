@@ -0,0 +1,179 @@
+﻿#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "Logger.h"
+
+#ifdef _LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// 쓰레드 하나당 io_context 하나를 소유하는 I/O 샤드 풀
+// - 세션/방은 생성 시 하나의 샤드에 고정되고, 이후 모든 핸들러는 그 샤드 쓰레드에서만 실행된다.
+class IoContextPool
+{
+public:
+    using WorkGuard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+    explicit IoContextPool(std::size_t pool_size, bool pin_threads = false)
+        : pin_threads_(pin_threads)
+    {
+        if (pool_size == 0)
+            pool_size = 1;
+
+        for (std::size_t i = 0; i < pool_size; ++i)
+        {
+            // 샤드당 쓰레드가 하나뿐이므로 concurrency hint 1로 내부 락을 줄인다.
+            auto io_context = std::make_unique<boost::asio::io_context>(1);
+            work_guards_.emplace_back(boost::asio::make_work_guard(*io_context));
+            io_contexts_.push_back(std::move(io_context));
+        }
+    }
+
+    IoContextPool(const IoContextPool&) = delete;
+    IoContextPool& operator=(const IoContextPool&) = delete;
+
+    // 샤드 쓰레드를 모두 띄우고 종료될 때까지 블록
+    void Run()
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(io_contexts_.size());
+
+        for (std::size_t i = 0; i < io_contexts_.size(); ++i)
+        {
+            threads.emplace_back([this, i]()
+                {
+                    if (pin_threads_)
+                        PinCurrentThread(i);
+
+                    io_contexts_[i]->run();
+                });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    void Stop()
+    {
+        for (auto& guard : work_guards_)
+        {
+            guard.reset();
+        }
+
+        for (auto& io_context : io_contexts_)
+        {
+            io_context->stop();
+        }
+    }
+
+    // Run()이 돌아온 뒤(샤드 쓰레드가 모두 끝난 뒤) 호출: 멈출 때 남아 있던 핸들러를 호출한 쓰레드에서 마저 실행
+    // - 취소된 타이머/소켓 작업의 완료가 큐에 남은 채 io_context가 파괴되면, 객체 안의 HandlerMemory에
+    //   들어 있던 작업 상태를 소유 객체가 사라진 뒤에 건드리게 된다. 소유 객체가 파괴되기 전에 비운다.
+    // - 한 샤드의 핸들러가 다른 샤드로 post할 수 있으므로 모든 샤드가 한 바퀴 동안 아무것도 실행하지 않을 때까지
+    void Drain()
+    {
+        std::size_t executed = 0;
+        do
+        {
+            executed = 0;
+            for (auto& io_context : io_contexts_)
+            {
+                io_context->restart();
+                executed += io_context->poll();
+            }
+        } while (executed != 0);
+    }
+
+    // 라운드 로빈으로 다음 샤드 반환 (새 세션/방 배치용)
+    boost::asio::io_context& GetNextIoContext()
+    {
+        return *io_contexts_[NextIndex()];
+    }
+
+    std::size_t NextIndex()
+    {
+        return next_index_.fetch_add(1, std::memory_order_relaxed) % io_contexts_.size();
+    }
+
+    boost::asio::io_context& GetIoContext(std::size_t index)
+    {
+        return *io_contexts_[index % io_contexts_.size()];
+    }
+
+    std::size_t Size() const { return io_contexts_.size(); }
+
+    // 빌드에 들어간 Asio 소켓 백엔드 (FIXER_USE_IO_URING 빌드면 io_uring)
+    static const char* BackendName()
+    {
+#if defined(BOOST_ASIO_HAS_IOCP)
+        return "iocp";
+#elif defined(BOOST_ASIO_HAS_IO_URING) && !defined(BOOST_ASIO_HAS_EPOLL)
+        return "io_uring";
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+        return "epoll";
+#else
+        return "select";
+#endif
+    }
+
+    // 모든 샤드가 지금 실행 중인 핸들러를 끝낸 뒤 fn 실행 (마지막으로 도착한 샤드에서)
+    // - 샤드마다 쓰레드가 하나뿐이므로, 표식 핸들러가 돌았다면 그 전에 시작한 핸들러는 모두 끝난 것
+    // - 핸들러가 잠깐 들고 있는 raw 포인터 대상을 안전하게 해제할 때 사용 (SlotMap)
+    template <typename Fn>
+    void PostAfterAllShards(Fn&& fn)
+    {
+        struct Pending
+        {
+            Pending(std::size_t count, Fn&& callback) : remaining(count), fn(std::forward<Fn>(callback)) {}
+
+            std::atomic<std::size_t> remaining;
+            std::decay_t<Fn> fn;
+        };
+        auto pending = std::make_shared<Pending>(io_contexts_.size(), std::forward<Fn>(fn));
+
+        for (auto& io_context : io_contexts_)
+        {
+            boost::asio::post(*io_context, [pending]()
+                {
+                    if (pending->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                        pending->fn();
+                });
+        }
+    }
+
+private:
+    static void PinCurrentThread(std::size_t index)
+    {
+#ifdef _LINUX
+        const unsigned int cores = std::thread::hardware_concurrency();
+        if (cores == 0)
+            return;
+
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(static_cast<int>(index % cores), &cpuset);
+
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0)
+        {
+            LOG_WARN("Failed to pin I/O thread %zu", index);
+        }
+#else
+        (void)index;
+#endif
+    }
+
+    std::vector<std::unique_ptr<boost::asio::io_context>> io_contexts_;
+    std::vector<WorkGuard> work_guards_;
+    std::atomic<std::size_t> next_index_{ 0 };
+    bool pin_threads_;
+};
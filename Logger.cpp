@@ -0,0 +1,149 @@
+﻿#include "Logger.h"
+
+#include <algorithm>
+#include <ctime>
+
+namespace
+{
+    constexpr std::size_t LINE_LEN = 512;
+    constexpr auto IDLE_WAIT = std::chrono::milliseconds(10);
+
+    const char* LevelName(LogLevel level)
+    {
+        switch (level)
+        {
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO ";
+        case LogLevel::Warn: return "WARN ";
+        case LogLevel::Error: return "ERROR";
+        }
+        return "?    ";
+    }
+}
+
+Logger& Logger::Instance()
+{
+    static Logger instance;
+    return instance;
+}
+
+Logger::Logger()
+    : thread_([this]() { Run(); })
+{
+}
+
+Logger::~Logger()
+{
+    Shutdown();
+}
+
+void Logger::Shutdown()
+{
+    if (!running_.exchange(false))
+        return;
+
+    wakeup_.notify_one();
+    if (thread_.joinable())
+        thread_.join();
+}
+
+log_detail::LogRing& Logger::LocalRing()
+{
+    // 쓰레드마다 처음 한 번만 등록 (링은 로거가 같이 소유하므로 쓰레드가 끝나도 남은 로그는 출력됨)
+    thread_local std::shared_ptr<log_detail::LogRing> ring = [this]()
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            auto created = std::make_shared<log_detail::LogRing>(static_cast<std::uint32_t>(rings_.size()));
+            rings_.push_back(created);
+            ring_count_.store(rings_.size(), std::memory_order_release);
+            return created;
+        }();
+    return *ring;
+}
+
+void Logger::Run()
+{
+    std::vector<char> batch;
+    batch.reserve(64 * 1024);
+
+    while (running_.load(std::memory_order_acquire))
+    {
+        if (DrainAll(batch) == 0)
+        {
+            std::unique_lock<std::mutex> lock(wakeup_mutex_);
+            wakeup_.wait_for(lock, IDLE_WAIT);
+        }
+    }
+
+    // 종료 전에 남은 것 모두 출력
+    DrainAll(batch);
+}
+
+std::size_t Logger::DrainAll(std::vector<char>& batch)
+{
+    if (drain_rings_.size() != ring_count_.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        drain_rings_ = rings_;
+    }
+    const auto& rings = drain_rings_;
+
+    batch.clear();
+    std::size_t drained = 0;
+    char line[LINE_LEN];
+
+    const std::uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+    if (dropped != 0)
+    {
+        const int len = std::snprintf(line, sizeof(line), "[WARN ] logger dropped %llu records (ring full)\n",
+            static_cast<unsigned long long>(dropped));
+        batch.insert(batch.end(), line, line + len);
+    }
+
+    // 여러 쓰레드의 링을 시각 순으로 합쳐서 출력
+    pending_.clear();
+    std::vector<std::uint64_t>& ends = drain_ends_;
+    ends.resize(rings.size());
+    for (std::size_t r = 0; r < rings.size(); ++r)
+    {
+        ends[r] = rings[r]->ReadEnd();
+        for (std::uint64_t i = rings[r]->ReadBegin(); i != ends[r]; ++i)
+            pending_.push_back({ &rings[r]->At(i), rings[r]->ThreadIndex() });
+    }
+    std::stable_sort(pending_.begin(), pending_.end(),
+        [](const PendingRecord& lhs, const PendingRecord& rhs) { return lhs.record->timestamp_us < rhs.record->timestamp_us; });
+
+    for (const auto& pending : pending_)
+    {
+        const log_detail::LogRecord& record = *pending.record;
+
+        // 시각 / 레벨 / 쓰레드
+        const std::time_t seconds = static_cast<std::time_t>(record.timestamp_us / 1000000);
+        const int millis = static_cast<int>((record.timestamp_us / 1000) % 1000);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &seconds);
+#else
+        localtime_r(&seconds, &local);
+#endif
+        int len = std::snprintf(line, sizeof(line), "%02d:%02d:%02d.%03d [%s] [t%u] ",
+            local.tm_hour, local.tm_min, local.tm_sec, millis,
+            LevelName(record.level), pending.thread_index);
+
+        const int body = record.format(line + len, sizeof(line) - len - 1, record.fmt, record.payload);
+        len = std::min<int>(len + std::max(body, 0), static_cast<int>(sizeof(line)) - 2);
+        line[len++] = '\n';
+        batch.insert(batch.end(), line, line + len);
+    }
+
+    for (std::size_t r = 0; r < rings.size(); ++r)
+        rings[r]->Release(ends[r]);
+    drained = pending_.size();
+
+    if (!batch.empty())
+    {
+        std::fwrite(batch.data(), 1, batch.size(), stdout);
+        std::fflush(stdout);
+    }
+    return drained;
+}
@@ -0,0 +1,272 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// ===== 비동기 로거 =====
+// - 호출한 쓰레드는 포맷 문자열 포인터와 인자 값만 자기 쓰레드 전용 링 버퍼(SPSC, 락 없음)에 복사하고 끝난다.
+// - 백그라운드 쓰레드가 모든 링을 모아서 포맷하고 한 번에 stdout으로 쓴다.
+// - 링이 가득 차면 기다리지 않고 버린다 (버린 개수는 다음 출력 때 알림).
+// - 포맷 문자열은 문자열 리터럴만 (포인터만 저장). 문자열 인자(const char*)는 기록 시점에 복사.
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+
+// 이 값보다 낮은 레벨의 로그는 컴파일에서 빠진다 (CMake FIXER_LOG_LEVEL로 지정)
+#ifndef FIXER_LOG_LEVEL
+#define FIXER_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+enum class LogLevel : std::uint8_t
+{
+    Debug = LOG_LEVEL_DEBUG,
+    Info = LOG_LEVEL_INFO,
+    Warn = LOG_LEVEL_WARN,
+    Error = LOG_LEVEL_ERROR,
+};
+
+namespace log_detail
+{
+    constexpr std::size_t PAYLOAD_LEN = 224;
+    constexpr std::size_t RING_LEN = 1024; // 쓰레드당 레코드 수 (2의 거듭제곱)
+    static_assert((RING_LEN & (RING_LEN - 1)) == 0, "RING_LEN must be a power of two");
+
+    // 인자를 payload에 직렬화/복원 (숫자/포인터는 그대로, 문자열은 NUL까지 복사)
+    template <typename T>
+    struct ArgCodec
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+            "log arguments must be numbers, pointers or C strings (use c_str())");
+
+        static bool Encode(char*& cursor, char* end, T value)
+        {
+            if (static_cast<std::size_t>(end - cursor) < sizeof(T))
+                return false;
+            std::memcpy(cursor, &value, sizeof(T));
+            cursor += sizeof(T);
+            return true;
+        }
+
+        static T Decode(const char*& cursor)
+        {
+            T value;
+            std::memcpy(&value, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return value;
+        }
+    };
+
+    template <>
+    struct ArgCodec<const char*>
+    {
+        static bool Encode(char*& cursor, char* end, const char* value)
+        {
+            if (cursor == end)
+                return false;
+
+            // 남은 공간만큼 잘라서 복사
+            const std::size_t len = value ? strnlen(value, static_cast<std::size_t>(end - cursor) - 1) : 0;
+            if (len != 0)
+                std::memcpy(cursor, value, len);
+            cursor[len] = '\0';
+            cursor += len + 1;
+            return true;
+        }
+
+        static const char* Decode(const char*& cursor)
+        {
+            const char* value = cursor;
+            cursor += std::strlen(cursor) + 1;
+            return value;
+        }
+    };
+
+    template <>
+    struct ArgCodec<char*> : ArgCodec<const char*>
+    {
+    };
+
+    // 레코드를 한 줄로 포맷하는 함수 (인자 타입 조합마다 하나씩 생성)
+    using FormatFn = int (*)(char* out, std::size_t cap, const char* fmt, const char* payload);
+
+    template <typename... Args>
+    int FormatRecord(char* out, std::size_t cap, const char* fmt, const char* payload)
+    {
+        if constexpr (sizeof...(Args) == 0)
+        {
+            return std::snprintf(out, cap, "%s", fmt);
+        }
+        else
+        {
+            // 중괄호 초기화는 왼쪽부터 평가되므로 인자 순서대로 복원된다
+            const char* cursor = payload;
+            std::tuple<Args...> args{ ArgCodec<Args>::Decode(cursor)... };
+            return std::apply([out, cap, fmt](auto... values) { return std::snprintf(out, cap, fmt, values...); }, args);
+        }
+    }
+
+    struct LogRecord
+    {
+        std::int64_t timestamp_us; // system_clock 기준
+        LogLevel level;
+        const char* fmt;
+        FormatFn format;
+        char payload[PAYLOAD_LEN];
+    };
+
+    // 한 쓰레드만 쓰고(Push) 로거 쓰레드만 읽는(Drain) 링 버퍼
+    class LogRing
+    {
+    public:
+        explicit LogRing(std::uint32_t thread_index) : thread_index_(thread_index) {}
+
+        // 비어 있는 다음 레코드 (가득 찼으면 nullptr)
+        LogRecord* Reserve()
+        {
+            const std::uint64_t head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) >= RING_LEN)
+                return nullptr;
+            return &records_[head & (RING_LEN - 1)];
+        }
+
+        void Commit() { head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+        // 로그 쓰레드: [ReadBegin, ReadEnd) 구간을 읽은 뒤 Release로 반납
+        std::uint64_t ReadBegin() const { return tail_.load(std::memory_order_relaxed); }
+        std::uint64_t ReadEnd() const { return head_.load(std::memory_order_acquire); }
+        const LogRecord& At(std::uint64_t index) const { return records_[index & (RING_LEN - 1)]; }
+        void Release(std::uint64_t end) { tail_.store(end, std::memory_order_release); }
+
+        std::uint32_t ThreadIndex() const { return thread_index_; }
+
+    private:
+        std::array<LogRecord, RING_LEN> records_;
+        alignas(64) std::atomic<std::uint64_t> head_{ 0 };
+        alignas(64) std::atomic<std::uint64_t> tail_{ 0 };
+        std::uint32_t thread_index_;
+    };
+}
+
+class Logger
+{
+public:
+    static Logger& Instance();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // 런타임 최소 레벨 (컴파일 레벨보다 낮출 수는 없음)
+    void SetMinLevel(LogLevel level) { min_level_.store(level, std::memory_order_relaxed); }
+    bool IsEnabled(LogLevel level) const { return level >= min_level_.load(std::memory_order_relaxed); }
+
+    template <typename... Args>
+    void Write(LogLevel level, const char* fmt, const Args&... args)
+    {
+        if (!IsEnabled(level))
+            return;
+
+        log_detail::LogRing& ring = LocalRing();
+        log_detail::LogRecord* record = ring.Reserve();
+        if (!record)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        record->timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        record->level = level;
+        record->fmt = fmt;
+        record->format = &log_detail::FormatRecord<std::decay_t<Args>...>;
+
+        if constexpr (sizeof...(Args) != 0)
+        {
+            char* cursor = record->payload;
+            char* const end = record->payload + sizeof(record->payload);
+            const bool fits = (log_detail::ArgCodec<std::decay_t<Args>>::Encode(cursor, end, args) && ...);
+            if (!fits)
+            {
+                // 인자가 너무 길면 포맷 문자열만 남긴다
+                record->format = &log_detail::FormatRecord<>;
+            }
+        }
+
+        ring.Commit();
+        if (level >= LogLevel::Warn)
+            wakeup_.notify_one();
+    }
+
+    // 남은 로그를 모두 출력하고 로거 쓰레드 종료 (main 끝에서 호출)
+    void Shutdown();
+
+private:
+    Logger();
+    ~Logger();
+
+    log_detail::LogRing& LocalRing();
+    void Run();
+    std::size_t DrainAll(std::vector<char>& batch);
+
+    struct PendingRecord
+    {
+        const log_detail::LogRecord* record;
+        std::uint32_t thread_index;
+    };
+    // 로그 쓰레드 전용 (매 출력마다 재사용, 링 목록은 쓰레드가 늘 때만 다시 복사)
+    std::vector<PendingRecord> pending_;
+    std::vector<std::shared_ptr<log_detail::LogRing>> drain_rings_;
+    std::vector<std::uint64_t> drain_ends_;
+
+    std::vector<std::shared_ptr<log_detail::LogRing>> rings_;
+    std::atomic<std::size_t> ring_count_{ 0 };
+    std::mutex rings_mutex_;
+
+    std::atomic<LogLevel> min_level_{ static_cast<LogLevel>(FIXER_LOG_LEVEL) };
+    std::atomic<std::uint64_t> dropped_{ 0 };
+
+    std::mutex wakeup_mutex_;
+    std::condition_variable wakeup_;
+    std::atomic<bool> running_{ true };
+    std::thread thread_;
+};
+
+// printf 형식 로그 매크로
+// - if (false) printf(...): 실행되지 않지만 컴파일러가 포맷/인자 타입을 검사해준다.
+#define FIXER_LOG_WRITE(level, ...) \
+    do { if (false) { std::printf(__VA_ARGS__); } Logger::Instance().Write(level, __VA_ARGS__); } while (0)
+
+#define FIXER_LOG_DISABLED(...) \
+    do { if (false) { std::printf(__VA_ARGS__); } } while (0)
+
+#if FIXER_LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) FIXER_LOG_WRITE(LogLevel::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) FIXER_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if FIXER_LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) FIXER_LOG_WRITE(LogLevel::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) FIXER_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if FIXER_LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) FIXER_LOG_WRITE(LogLevel::Warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) FIXER_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#define LOG_ERROR(...) FIXER_LOG_WRITE(LogLevel::Error, __VA_ARGS__)
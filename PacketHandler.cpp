@@ -2,94 +2,98 @@
 #include "Session.h"
 #include "GameServer.h"
 #include "Protocol.h"
+#include "Logger.h"
 
-// ===== Login =====
-void LoginHandler::HandlePacket(std::shared_ptr<Session> session,
-    const char* data, std::size_t size)
-{
-    if (size < sizeof(PKT_REQ_LOGIN))
-        return;
+#include <array>
+#include <cstring>
+#include <type_traits>
 
-    const auto& request = *reinterpret_cast<const PKT_REQ_LOGIN*>(data);
-    server_.ProcessLogin(session, request);
-}
-
-// ===== Logout =====
-void LogoutHandler::HandlePacket(std::shared_ptr<Session> session,
-    const char* data, std::size_t size)
+namespace
 {
-    if (size < sizeof(PKT_REQ_LOGOUT))
-        return;
-
-    const auto& request = *reinterpret_cast<const PKT_REQ_LOGOUT*>(data);
-    server_.ProcessLogout(session, request);
-}
-
-// ===== Chat =====
-void ChatMessageHandler::HandlePacket(std::shared_ptr<Session> session,
-    const char* data, std::size_t size)
-{
-    if (!session->IsAuthenticated())
-        return;
-
-    if (size < sizeof(PKT_REQ_CHAT))
-        return;
-
-    const auto& message = *reinterpret_cast<const PKT_REQ_CHAT*>(data);
-    server_.ProcessChatMessage(session, message);
-}
-
-// ===== Room Create =====
-void CreateRoomHandler::HandlePacket(std::shared_ptr<Session> session,
-    const char* data, std::size_t size)
-{
-    if (size < sizeof(PKT_REQ_CREATE_ROOM))
-        return;
-
-    const auto& request = *reinterpret_cast<const PKT_REQ_CREATE_ROOM*>(data);
-    server_.ProcessCreateRoom(session, request);
+    // 패킷 크기 검사(가변 길이 포함) 후 GameServer의 처리 함수 호출
+    template <typename Packet, void (GameServer::*Handler)(Session&, const Packet&)>
+    void InvokeHandler(GameServer& server, Session& session,
+        const char* data, std::size_t size)
+    {
+        const auto& packet = *reinterpret_cast<const Packet*>(data);
+        if (!IsValidPacketSize(packet, size))
+            return;
+
+        // 구조체보다 짧은 패킷(가변 길이, 이전 버전)은 뒤를 0으로 채운 복사본으로 넘김
+        // - 수신 버퍼 뒤쪽(다음 패킷)을 필드로 읽지 않도록
+        if (size < sizeof(Packet))
+        {
+            Packet padded{};
+            std::memcpy(&padded, data, size);
+            (server.*Handler)(session, padded);
+            return;
+        }
+
+        (server.*Handler)(session, packet);
+    }
+
+    struct PacketBinding
+    {
+        PACKET_ID pkt_id;
+        PacketHandlerFn handler;
+    };
+
+    template <PACKET_ID Id, typename Packet, void (GameServer::*Handler)(Session&, const Packet&)>
+    constexpr PacketBinding Bind()
+    {
+        static_assert(std::is_base_of_v<PACKET_HEADER, Packet>, "packet must start with PACKET_HEADER");
+        static_assert(std::is_trivially_copyable_v<Packet>, "packet must be trivially copyable");
+        static_assert(sizeof(Packet) <= MAX_RECEIVE_BUFFER_LEN, "packet exceeds MAX_RECEIVE_BUFFER_LEN");
+        static_assert(Id < PACKET_DISPATCH_TABLE_SIZE, "packet id exceeds PACKET_DISPATCH_TABLE_SIZE");
+
+        return { Id, &InvokeHandler<Packet, Handler> };
+    }
+
+    template <std::size_t N>
+    constexpr std::array<PacketHandlerFn, PACKET_DISPATCH_TABLE_SIZE>
+        MakeDispatchTable(const PacketBinding(&bindings)[N])
+    {
+        std::array<PacketHandlerFn, PACKET_DISPATCH_TABLE_SIZE> table{};
+        for (const auto& binding : bindings)
+        {
+            if (table[binding.pkt_id] != nullptr)
+                throw "duplicate packet handler"; // 컴파일 에러
+
+            table[binding.pkt_id] = binding.handler;
+        }
+        return table;
+    }
+
+    //==================== 핸들러 등록 ====================
+    constexpr PacketBinding PACKET_BINDINGS[] = {
+        Bind<REQ_LOGIN,        PKT_REQ_LOGIN,        &GameServer::ProcessLogin>(),
+        Bind<REQ_LOGOUT,       PKT_REQ_LOGOUT,       &GameServer::ProcessLogout>(),
+        Bind<REQ_CHAT,         PKT_REQ_CHAT,         &GameServer::ProcessChatMessage>(),
+        Bind<REQ_CREATE_ROOM,  PKT_REQ_CREATE_ROOM,  &GameServer::ProcessCreateRoom>(),
+        Bind<REQ_ENTER_ROOM,   PKT_REQ_ENTER_ROOM,   &GameServer::ProcessEnterRoom>(),
+        Bind<REQ_LEAVE_ROOM,   PKT_REQ_LEAVE_ROOM,   &GameServer::ProcessLeaveRoom>(),
+        Bind<REQ_ROOM_LIST,    PKT_REQ_ROOM_LIST,    &GameServer::ProcessRoomListRequest>(),
+        Bind<REQ_PLAYER_STATE, PKT_REQ_PLAYER_STATE, &GameServer::ProcessPlayerState>(),
+        Bind<REQ_SNAPSHOT_ACK, PKT_REQ_SNAPSHOT_ACK, &GameServer::ProcessSnapshotAck>(),
+    };
+
+    constexpr auto PACKET_DISPATCH_TABLE = MakeDispatchTable(PACKET_BINDINGS);
 }
 
-// ===== Room Enter =====
-void EnterRoomHandler::HandlePacket(std::shared_ptr<Session> session,
+void PacketDispatcher::DispatchPacket(Session& session,
+    const PACKET_HEADER& header,
     const char* data, std::size_t size)
 {
-    if (size < sizeof(PKT_REQ_ENTER_ROOM))
-        return;
-
-    const auto& request = *reinterpret_cast<const PKT_REQ_ENTER_ROOM*>(data);
-    server_.ProcessEnterRoom(session, request);
-}
-
-// ===== Room Leave =====
-void LeaveRoomHandler::HandlePacket(std::shared_ptr<Session> session,
-    const char* data, std::size_t size)
-{
-    if (size < sizeof(PKT_REQ_LEAVE_ROOM))
-        return;
-
-    const auto& request = *reinterpret_cast<const PKT_REQ_LEAVE_ROOM*>(data);
-    server_.ProcessLeaveRoom(session, request);
-}
-
-// ===== Room List =====
-void RoomListHandler::HandlePacket(std::shared_ptr<Session> session,
-    const char* data, std::size_t size)
-{
-    if (size < sizeof(PKT_REQ_ROOM_LIST))
-        return;
-
-    const auto& request = *reinterpret_cast<const PKT_REQ_ROOM_LIST*>(data);
-    server_.ProcessRoomListRequest(session, request);
-}
-
-// ===== Player Input =====
-void PlayerStateHandler::HandlePacket(std::shared_ptr<Session> session,
-    const char* data, std::size_t size)
-{
-    if (size < sizeof(PKT_REQ_PLAYER_STATE))
-        return;
-
-    const auto& request = *reinterpret_cast<const PKT_REQ_PLAYER_STATE*>(data);
-    server_.ProcessPlayerState(session, request);
+    const std::size_t index = header.pkt_id;
+    PacketHandlerFn handler =
+        index < PACKET_DISPATCH_TABLE.size() ? PACKET_DISPATCH_TABLE[index] : nullptr;
+
+    if (handler != nullptr)
+    {
+        handler(server_, session, data, size);
+    }
+    else
+    {
+        LOG_WARN("Unknown packet id: %u", static_cast<unsigned int>(header.pkt_id));
+    }
 }
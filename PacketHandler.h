@@ -1,150 +1,30 @@
 ﻿#pragma once
 
-#include <unordered_map>
-#include <memory>
-#include <iostream>
+#include <cstddef>
 
 #include "Protocol.h"
 
 class GameServer;
 class Session;
 
-// ===== 패킷 핸들러 인터페이스 =====
-class IPacketHandler
-{
-public:
-    virtual ~IPacketHandler() = default;
+// 디스패치 테이블 크기 (PACKET_ID 값이 이보다 작아야 함)
+constexpr std::size_t PACKET_DISPATCH_TABLE_SIZE = 64;
 
-    virtual void HandlePacket(
-        std::shared_ptr<Session> session,
-        const char* data,
-        std::size_t size) = 0;
-};
+// 패킷 ID로 바로 인덱싱되는 핸들러 (크기 검사 + 캐스팅 후 GameServer::ProcessXXX 호출)
+using PacketHandlerFn = void (*)(GameServer& server, Session& session,
+    const char* data, std::size_t size);
 
 // ===== 패킷 디스패처 =====
+// 핸들러 등록은 PacketHandler.cpp의 PACKET_BINDINGS에서 컴파일 타임에 이루어진다.
 class PacketDispatcher
 {
 public:
-    void RegisterHandler(PACKET_ID pkt_id, std::unique_ptr<IPacketHandler> handler)
-    {
-        handlers_[pkt_id] = std::move(handler);
-    }
+    explicit PacketDispatcher(GameServer& server) : server_(server) {}
 
-    void DispatchPacket(std::shared_ptr<Session> session,
+    void DispatchPacket(Session& session,
         const PACKET_HEADER& header,
-        const char* data, std::size_t size)
-    {
-        auto it = handlers_.find(static_cast<PACKET_ID>(header.pkt_id));
-        if (it != handlers_.end())
-        {
-            it->second->HandlePacket(session, data, size);
-        }
-        else
-        {
-            std::cout << "Unknown packet id: "
-                << static_cast<uint16_t>(header.pkt_id) << std::endl;
-        }
-    }
-
-private:
-    std::unordered_map<PACKET_ID, std::unique_ptr<IPacketHandler>> handlers_;
-};
-
-//==================== 개별 핸들러들 ====================
-
-class LoginHandler : public IPacketHandler
-{
-public:
-    explicit LoginHandler(GameServer& server) : server_(server) {}
-
-    void HandlePacket(std::shared_ptr<Session> session,
-        const char* data, std::size_t size) override;
-
-private:
-    GameServer& server_;
-};
-
-class LogoutHandler : public IPacketHandler
-{
-public:
-    explicit LogoutHandler(GameServer& server) : server_(server) {}
-
-    void HandlePacket(std::shared_ptr<Session> session,
-        const char* data, std::size_t size) override;
-
-private:
-    GameServer& server_;
-};
-
-class ChatMessageHandler : public IPacketHandler
-{
-public:
-    explicit ChatMessageHandler(GameServer& server) : server_(server) {}
-
-    void HandlePacket(std::shared_ptr<Session> session,
-        const char* data, std::size_t size) override;
-
-private:
-    GameServer& server_;
-};
-
-class CreateRoomHandler : public IPacketHandler
-{
-public:
-    explicit CreateRoomHandler(GameServer& server) : server_(server) {}
-
-    void HandlePacket(std::shared_ptr<Session> session,
-        const char* data, std::size_t size) override;
-
-private:
-    GameServer& server_;
-};
-
-class EnterRoomHandler : public IPacketHandler
-{
-public:
-    explicit EnterRoomHandler(GameServer& server) : server_(server) {}
-
-    void HandlePacket(std::shared_ptr<Session> session,
-        const char* data, std::size_t size) override;
-
-private:
-    GameServer& server_;
-};
-
-class LeaveRoomHandler : public IPacketHandler
-{
-public:
-    explicit LeaveRoomHandler(GameServer& server) : server_(server) {}
-
-    void HandlePacket(std::shared_ptr<Session> session,
-        const char* data, std::size_t size) override;
+        const char* data, std::size_t size);
 
 private:
     GameServer& server_;
 };
-
-class RoomListHandler : public IPacketHandler
-{
-public:
-    explicit RoomListHandler(GameServer& server) : server_(server) {}
-
-    void HandlePacket(std::shared_ptr<Session> session,
-        const char* data, std::size_t size) override;
-
-private:
-    GameServer& server_;
-};
-
-class PlayerStateHandler : public IPacketHandler
-{
-public:
-    explicit PlayerStateHandler(GameServer& server) : server_(server) {}
-
-    void HandlePacket(std::shared_ptr<Session> session,
-        const char* data, std::size_t size) override;
-
-private:
-    GameServer& server_;
-};
-
@@ -4,7 +4,11 @@
 #include <cstring>
 
 constexpr std::uint16_t PORT_NUMBER = 31452;
+constexpr std::uint16_t UDP_PORT_NUMBER = PORT_NUMBER + 1; // 상태 전용 UDP 채널 (--udp로 켰을 때만)
 constexpr std::uint16_t MAX_RECEIVE_BUFFER_LEN = 512;
+constexpr std::uint16_t SESSION_RECV_BUFFER_LEN = MAX_RECEIVE_BUFFER_LEN * 16; // 세션 수신 버퍼 (패킷 여러 개를 한 번에 수신)
+constexpr std::uint16_t SESSION_SEND_BATCH_LEN = MAX_RECEIVE_BUFFER_LEN * 32;  // 한 번의 writev로 보낼 최대 바이트
+constexpr std::uint16_t SESSION_SEND_BATCH_COUNT = 64;                          // 한 번의 writev로 보낼 최대 패킷 수
 
 constexpr std::uint16_t MAX_ID_LEN = 32;
 constexpr std::uint16_t MAX_PW_LEN = 32;
@@ -13,6 +17,7 @@ constexpr std::uint16_t MAX_ROOM_NAME_LEN = 32;
 constexpr std::uint16_t MAX_MESSAGE_LEN = 128;
 
 constexpr std::uint16_t MAX_PLAYERS_PER_ROOM = 16;
+constexpr std::uint16_t MAX_COMPACT_STATE_BYTES = MAX_PLAYERS_PER_ROOM * 6; // 항목당 최대 48비트 (슬롯 16 + 좌표 16x2)
 
 #pragma pack(push, 1)
 struct PACKET_HEADER
@@ -47,10 +52,21 @@ enum PACKET_ID : std::uint16_t {
 
     REQ_PLAYER_STATE = 40,
     NOTICE_PLAYER_STATE = 41,
+    NOTICE_PLAYER_STATE_DELTA = 42,
+    REQ_SNAPSHOT_ACK = 43,
+    NOTICE_PLAYER_STATE_COMPACT = 44,
+    NOTICE_ROOM_SLOT = 45,
+    NOTICE_ROOM_LAYOUT = 46,
 
     NOTICE_GAME_CLEAR = 50,
 };
 
+// 상태 패킷 포맷 (로그인 시 협상)
+enum WIRE_FORMAT : std::uint8_t {
+    WIRE_FORMAT_DEFAULT = 0, // float 좌표 + 32비트 userId
+    WIRE_FORMAT_COMPACT = 1, // 양자화 좌표 + 방 슬롯 번호, 비트 패킹
+};
+
 struct CharacterState
 {
     float pos_x;
@@ -58,10 +74,19 @@ struct CharacterState
 };
 
 // 로그인 요청
+// - wireFormat이 생기기 전 클라이언트는 그 1바이트 없이 보낸다 (REQ_LOGIN_LEGACY_SIZE, WIRE_FORMAT_DEFAULT로 처리)
 struct PKT_REQ_LOGIN : public PACKET_HEADER
 {
     char userId[MAX_ID_LEN];
     char password[MAX_PW_LEN];
+    std::uint8_t wireFormat; // 원하는 WIRE_FORMAT
+};
+
+// UDP 상태 채널 토큰 (로그인 응답으로 받아 데이터그램마다 그대로 붙인다)
+struct UDP_TOKEN
+{
+    std::uint32_t session; // 서버 세션 핸들
+    std::uint64_t secret;  // 로그인마다 OS 난수에서 새로 뽑는 값 (0이면 UDP 채널 없음)
 };
 
 // 로그인 응답
@@ -69,6 +94,8 @@ struct PKT_RES_LOGIN : public PACKET_HEADER
 {
     uint32_t userId;
     bool isSuccess;
+    std::uint8_t wireFormat; // 서버가 수락한 WIRE_FORMAT
+    UDP_TOKEN udpToken;      // UDP 상태 채널 토큰
 };
 
 // 로그아웃 요청
@@ -144,17 +171,29 @@ struct PKT_RES_ROOM_LIST : public PACKET_HEADER
     std::uint16_t roomCount;
 };
 
-// 채팅 요청
+// 채팅 채널
+enum CHAT_CHANNEL : std::uint8_t {
+    CHAT_CHANNEL_ROOM = 0,    // 보낸 유저가 마지막으로 입장한 방 (기본)
+    CHAT_CHANNEL_GLOBAL = 1,  // 접속한 모든 유저
+    CHAT_CHANNEL_WHISPER = 2, // targetName 유저 한 명 (보낸 유저에게도 에코)
+};
+
+// 채팅 요청 (가변 길이: pkt_size = 헤더 + 1 + MAX_NAME_LEN + 1 + messageLen)
 struct PKT_REQ_CHAT : public PACKET_HEADER
 {
-    char message[MAX_MESSAGE_LEN];
+    std::uint8_t channel;              // CHAT_CHANNEL
+    char targetName[MAX_NAME_LEN];     // 귓속말 대상 (그 외 채널은 무시)
+    std::uint8_t messageLen;
+    char message[MAX_MESSAGE_LEN]; // NUL 종료 없음
 };
 
-// 채팅 브로드캐스트
+// 채팅 브로드캐스트 (가변 길이: text = senderName 뒤에 message, NUL 종료 없음)
 struct PKT_NOTICE_CHAT : public PACKET_HEADER
 {
-    char senderName[MAX_NAME_LEN];
-    char message[MAX_MESSAGE_LEN];
+    std::uint8_t channel; // CHAT_CHANNEL
+    std::uint8_t senderNameLen;
+    std::uint8_t messageLen;
+    char text[MAX_NAME_LEN + MAX_MESSAGE_LEN];
 };
 
 // 플레이어 상태 전송
@@ -168,11 +207,85 @@ struct PlayerStateEntry {
     CharacterState state;
 };
 
-// 플레이어 상태 브로드캐스트
+// 상태 스냅샷 정보 (NOTICE_PLAYER_STATE에서는 players[count] 바로 뒤에 붙는다)
+struct PlayerStateSnapshotInfo
+{
+    std::uint32_t snapshotSeq;
+    std::uint8_t partIndex;
+    std::uint8_t partCount;
+};
+
+// 플레이어 상태 브로드캐스트 (가변 길이: count, players[count], PlayerStateSnapshotInfo 순으로 전송)
+// - count / players 배치는 처음 프로토콜 그대로: 이전 클라이언트는 count개만 읽고 뒤에 붙은 정보는 무시한다.
+// - 전체 스냅샷. 클라이언트는 snapshotSeq를 REQ_SNAPSHOT_ACK로 확인해주면 이후 델타를 받는다.
+// - 큰 방(AOI)에서는 시야 안의 플레이어만, 가까운 순으로 여러 패킷(partIndex / partCount)에 나눠 보낸다.
+//   같은 snapshotSeq의 패킷을 모두 합친 것이 그 유저의 시야 전체이고, 큰 방에서는 델타 없이 항상 전체 스냅샷.
 struct PKT_NOTICE_PLAYER_STATE : public PACKET_HEADER
 {
     std::uint16_t count;
     PlayerStateEntry players[MAX_PLAYERS_PER_ROOM];
+    PlayerStateSnapshotInfo info; // 최대 크기 확보용, 실제 위치는 players[count] 뒤 (Write/ReadPlayerStateInfo)
+};
+
+enum PLAYER_DELTA_FLAG : std::uint8_t {
+    PLAYER_DELTA_CHANGED = 0, // 상태 변경
+    PLAYER_DELTA_JOINED = 1,  // 기준 스냅샷 이후 입장
+    PLAYER_DELTA_LEFT = 2,    // 기준 스냅샷 이후 퇴장 (state는 0)
+};
+
+struct PlayerStateDeltaEntry {
+    std::uint32_t userId;
+    std::uint8_t flag;
+    CharacterState state;
+};
+
+// 플레이어 상태 델타 브로드캐스트 (가변 길이: entries는 count개만 전송)
+// - 클라이언트가 마지막으로 확인한 스냅샷(baselineSeq) 대비 바뀐 항목만 담는다.
+// - baselineSeq 스냅샷에 entries를 적용하면 snapshotSeq 스냅샷이 된다.
+struct PKT_NOTICE_PLAYER_STATE_DELTA : public PACKET_HEADER
+{
+    std::uint32_t snapshotSeq;
+    std::uint32_t baselineSeq;
+    std::uint16_t count;
+    PlayerStateDeltaEntry entries[MAX_PLAYERS_PER_ROOM * 2];
+};
+
+// 스냅샷 수신 확인
+struct PKT_REQ_SNAPSHOT_ACK : public PACKET_HEADER
+{
+    std::uint32_t snapshotSeq;
+};
+
+// 압축 포맷: 방 좌표 범위 / 비트 수 (입장 시 1회)
+struct PKT_NOTICE_ROOM_LAYOUT : public PACKET_HEADER
+{
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+    std::uint8_t positionBits;
+    std::uint8_t slotBits;
+};
+
+// 압축 포맷: 방 슬롯 배정 변경 (userId 0이면 슬롯 비워짐 = 퇴장)
+struct PKT_NOTICE_ROOM_SLOT : public PACKET_HEADER
+{
+    std::uint16_t slot;
+    std::uint32_t userId;
+};
+
+// 압축 포맷 상태 브로드캐스트 (가변 길이)
+// - data: count개 항목, 항목마다 slot(slotBits) / x(positionBits) / y(positionBits), LSB부터 비트 패킹
+// - baselineSeq가 0이면 전체 스냅샷, 아니면 그 스냅샷 대비 바뀐 슬롯만 (입/퇴장은 NOTICE_ROOM_SLOT)
+// - 큰 방(AOI)에서는 NOTICE_PLAYER_STATE와 같은 방식으로 시야 안의 전체 스냅샷을 여러 패킷에 나눠 보낸다.
+struct PKT_NOTICE_PLAYER_STATE_COMPACT : public PACKET_HEADER
+{
+    std::uint32_t snapshotSeq;
+    std::uint32_t baselineSeq;
+    std::uint8_t partIndex;
+    std::uint8_t partCount;
+    std::uint8_t count;
+    std::uint8_t data[MAX_COMPACT_STATE_BYTES];
 };
 
 // 게임 클리어 브로드캐스트
@@ -181,7 +294,116 @@ struct PKT_NOTICE_GAME_CLEAR : public PACKET_HEADER
     char winnerName[MAX_NAME_LEN];
 };
 
-
+// ===== UDP 상태 채널 =====
+// 데이터그램 하나 = UDP_HEADER + 패킷 하나 (PACKET_HEADER + 바디, TCP와 같은 형식)
+// - 클라이언트 -> 서버: REQ_PLAYER_STATE / REQ_SNAPSHOT_ACK만 받는다. 첫 유효 데이터그램의 주소로 채널이 연결된다.
+// - 서버 -> 클라이언트: 채널이 연결된 세션의 NOTICE_PLAYER_STATE(_DELTA/_COMPACT)만 UDP로, 나머지는 계속 TCP.
+// - 받는 쪽은 sequence가 마지막으로 받은 것보다 새롭지 않으면 버린다 (늦게 온 스냅샷/중복).
+struct UDP_HEADER
+{
+    UDP_TOKEN token;        // 로그인 응답의 udpToken (서버 -> 클라이언트도 같은 값)
+    std::uint32_t sequence; // 보내는 쪽이 데이터그램마다 1부터 1씩 증가
+};
 
 #pragma pack(pop)
 
+// ===== 가변 길이 패킷 크기 / 작성 / 검증 =====
+
+constexpr std::uint16_t NoticePlayerStateSize(std::uint16_t count)
+{
+    return static_cast<std::uint16_t>(
+        sizeof(PACKET_HEADER) + sizeof(std::uint16_t) + count * sizeof(PlayerStateEntry) +
+        sizeof(PlayerStateSnapshotInfo));
+}
+
+constexpr std::uint16_t NoticePlayerStateDeltaSize(std::uint16_t count)
+{
+    return static_cast<std::uint16_t>(
+        sizeof(PACKET_HEADER) + sizeof(std::uint32_t) * 2 + sizeof(std::uint16_t) +
+        count * sizeof(PlayerStateDeltaEntry));
+}
+
+constexpr std::uint16_t NoticePlayerStateCompactSize(std::size_t data_bytes)
+{
+    return static_cast<std::uint16_t>(
+        sizeof(PACKET_HEADER) + sizeof(std::uint32_t) * 2 + sizeof(std::uint8_t) * 3 + data_bytes);
+}
+
+constexpr std::uint16_t ReqChatSize(std::size_t message_len)
+{
+    return static_cast<std::uint16_t>(sizeof(PACKET_HEADER) + 1 + MAX_NAME_LEN + 1 + message_len);
+}
+
+constexpr std::uint16_t NoticeChatSize(std::size_t sender_len, std::size_t message_len)
+{
+    return static_cast<std::uint16_t>(sizeof(PACKET_HEADER) + 3 + sender_len + message_len);
+}
+
+static_assert(NoticePlayerStateSize(MAX_PLAYERS_PER_ROOM) == sizeof(PKT_NOTICE_PLAYER_STATE), "NOTICE_PLAYER_STATE layout");
+static_assert(NoticePlayerStateDeltaSize(MAX_PLAYERS_PER_ROOM * 2) == sizeof(PKT_NOTICE_PLAYER_STATE_DELTA), "NOTICE_PLAYER_STATE_DELTA layout");
+static_assert(sizeof(PKT_NOTICE_PLAYER_STATE_DELTA) <= MAX_RECEIVE_BUFFER_LEN, "NOTICE_PLAYER_STATE_DELTA too big");
+static_assert(NoticePlayerStateCompactSize(MAX_COMPACT_STATE_BYTES) == sizeof(PKT_NOTICE_PLAYER_STATE_COMPACT), "NOTICE_PLAYER_STATE_COMPACT layout");
+static_assert(ReqChatSize(MAX_MESSAGE_LEN) == sizeof(PKT_REQ_CHAT), "REQ_CHAT layout");
+static_assert(NoticeChatSize(MAX_NAME_LEN, MAX_MESSAGE_LEN) == sizeof(PKT_NOTICE_CHAT), "NOTICE_CHAT layout");
+
+// 채팅 알림 작성 (긴 문자열은 잘림), 전송할 크기(pkt_size) 반환
+inline std::uint16_t MakeNoticeChat(PKT_NOTICE_CHAT& pkt, CHAT_CHANNEL channel,
+    const char* sender, const char* message, std::size_t message_len)
+{
+    const std::size_t sender_len = strnlen(sender, MAX_NAME_LEN);
+    if (message_len > MAX_MESSAGE_LEN)
+        message_len = MAX_MESSAGE_LEN;
+
+    pkt.pkt_id = NOTICE_CHAT;
+    pkt.channel = channel;
+    pkt.senderNameLen = static_cast<std::uint8_t>(sender_len);
+    pkt.messageLen = static_cast<std::uint8_t>(message_len);
+    std::memcpy(pkt.text, sender, sender_len);
+    std::memcpy(pkt.text + sender_len, message, message_len);
+    pkt.pkt_size = NoticeChatSize(sender_len, message_len);
+    return pkt.pkt_size;
+}
+
+// NOTICE_PLAYER_STATE의 스냅샷 정보 쓰기/읽기 (players[count] 바로 뒤, count를 먼저 채운 뒤 호출)
+inline void WritePlayerStateInfo(PKT_NOTICE_PLAYER_STATE& pkt, const PlayerStateSnapshotInfo& info)
+{
+    std::memcpy(reinterpret_cast<char*>(pkt.players) + pkt.count * sizeof(PlayerStateEntry), &info, sizeof(info));
+}
+
+inline PlayerStateSnapshotInfo ReadPlayerStateInfo(const PKT_NOTICE_PLAYER_STATE& pkt)
+{
+    PlayerStateSnapshotInfo info;
+    std::memcpy(&info, reinterpret_cast<const char*>(pkt.players) + pkt.count * sizeof(PlayerStateEntry), sizeof(info));
+    return info;
+}
+
+// 수신 패킷 크기 검증: 고정 길이 패킷은 구조체 크기 이상이면 통과
+template <typename Packet>
+inline bool IsValidPacketSize(const Packet& /*packet*/, std::size_t size)
+{
+    return size >= sizeof(Packet);
+}
+
+// 로그인 요청은 wireFormat이 없는 이전 크기도 받는다
+constexpr std::size_t REQ_LOGIN_LEGACY_SIZE = sizeof(PKT_REQ_LOGIN) - sizeof(std::uint8_t);
+
+inline bool IsValidPacketSize(const PKT_REQ_LOGIN& /*packet*/, std::size_t size)
+{
+    return size >= REQ_LOGIN_LEGACY_SIZE;
+}
+
+// 가변 길이 채팅 요청은 길이 필드와 실제 크기가 정확히 맞아야 함
+inline bool IsValidPacketSize(const PKT_REQ_CHAT& packet, std::size_t size)
+{
+    if (size < ReqChatSize(0))
+        return false;
+
+    return packet.messageLen <= MAX_MESSAGE_LEN &&
+        size == ReqChatSize(packet.messageLen);
+}
+
+// UDP sequence 비교 (한 바퀴 돌아도 최근 2^31개 안에서는 올바르게 판단)
+inline bool IsNewerSequence(std::uint32_t sequence, std::uint32_t last)
+{
+    return static_cast<std::int32_t>(sequence - last) > 0;
+}
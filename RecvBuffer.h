@@ -0,0 +1,59 @@
+﻿#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include <boost/asio/buffer.hpp>
+
+#include "Protocol.h"
+
+// 세션별 수신 버퍼
+// - async_read_some으로 빈 공간을 채우고, 완성된 패킷은 버퍼 안에서 그대로 파싱한다.
+// - 남은 조각(미완성 패킷)은 공간이 부족할 때만 앞으로 당겨서, 패킷이 항상 연속된 메모리에 놓이도록 한다.
+class RecvBuffer
+{
+public:
+    // 읽기 가능한(아직 처리 안 된) 데이터
+    const char* ReadPtr() const { return buffer_.data() + read_pos_; }
+    std::size_t ReadableSize() const { return write_pos_ - read_pos_; }
+
+    // 소켓에서 받은 데이터를 채울 빈 공간
+    boost::asio::mutable_buffer WritableBuffer()
+    {
+        return boost::asio::buffer(buffer_.data() + write_pos_, buffer_.size() - write_pos_);
+    }
+
+    void CommitWrite(std::size_t bytes) { write_pos_ += bytes; }
+
+    void ConsumeRead(std::size_t bytes)
+    {
+        read_pos_ += bytes;
+        if (read_pos_ == write_pos_)
+        {
+            // 다 처리했으면 복사 없이 처음으로 되감기
+            read_pos_ = 0;
+            write_pos_ = 0;
+        }
+    }
+
+    // 최대 크기 패킷 하나가 더 들어갈 공간이 없으면 남은 조각을 앞으로 이동
+    void Compact()
+    {
+        if (buffer_.size() - write_pos_ >= MAX_RECEIVE_BUFFER_LEN)
+            return;
+
+        const std::size_t remain = ReadableSize();
+        if (remain > 0 && read_pos_ > 0)
+        {
+            std::memmove(buffer_.data(), buffer_.data() + read_pos_, remain);
+        }
+        read_pos_ = 0;
+        write_pos_ = remain;
+    }
+
+private:
+    std::array<char, SESSION_RECV_BUFFER_LEN> buffer_{};
+    std::size_t read_pos_ = 0;
+    std::size_t write_pos_ = 0;
+};
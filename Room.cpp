@@ -1,91 +1,414 @@
 ﻿#include "Room.h"
 #include "Protocol.h"
+#include "Logger.h"
+#include <algorithm>
 #include <cstdio>
-#include <iostream>
+#include <random>
 
-void Room::StartTick()
+uint32_t Room::RandomSnapshotSeqStart()
 {
-    ScheduleNextTick();
+    thread_local std::random_device device;
+    return device();
 }
 
-bool Room::AddUser(std::shared_ptr<User> user)
+void Room::AddUser(std::shared_ptr<User> user, RoomResultHandler on_complete)
 {
-    size_t userCount = 0;
+    auto self = shared_from_this();
+    boost::asio::post(strand_, [self, user = std::move(user), on_complete = std::move(on_complete)]()
+        {
+            const bool added = self->AddUserOnStrand(user);
+            if (on_complete)
+                on_complete(added);
+        });
+}
+
+void Room::RemoveUser(uint32_t user_id, RoomResultHandler on_complete)
+{
+    auto self = shared_from_this();
+    boost::asio::post(strand_, [self, user_id, on_complete = std::move(on_complete)]()
+        {
+            const bool removed = self->RemoveUserOnStrand(user_id);
+            if (on_complete)
+                on_complete(removed);
+        });
+}
+
+void Room::QueueDeparture(uint32_t user_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(departures_mutex_);
+        pending_departures_.push_back(user_id);
+        if (departure_flush_posted_)
+            return; // 이미 예약된 처리에 합류
+        departure_flush_posted_ = true;
+    }
+
+    auto self = shared_from_this();
+    boost::asio::post(strand_, [self]() { self->FlushDepartures(); });
+}
+
+void Room::FlushDepartures()
+{
+    std::vector<uint32_t> departures;
+    {
+        std::lock_guard<std::mutex> lock(departures_mutex_);
+        departures.swap(pending_departures_);
+        departure_flush_posted_ = false;
+    }
+
+    std::size_t removed = 0;
+    std::string last_username;
+    for (uint32_t user_id : departures)
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
+        auto it = user_slots_.find(user_id);
+        if (it == user_slots_.end())
+            continue;
+
+        last_username = slot_users_[it->second]->GetUsername();
+        if (RemoveUserOnStrand(user_id, false))
+            ++removed;
+    }
+
+    if (removed == 0 || user_slots_.empty())
+        return;
+
+    std::string notification = removed == 1
+        ? last_username + " left the room."
+        : std::to_string(removed) + " users left the room.";
+    BroadcastNotification(notification, 0);
+    BroadcastRoomInfo();
+}
+
+bool Room::AddUserOnStrand(const std::shared_ptr<User>& user)
+{
+    if (user_slots_.size() >= max_users_)
+        return false;
 
-        if (users_.size() >= max_users_)
-            return false;
+    if (user_slots_.find(user->GetId()) != user_slots_.end())
+        return false; // 이미 방에 있음
 
-        if (users_.find(user->GetId()) != users_.end())
-            return false; // 이미 방에 있음
+    // 비어 있는 가장 작은 슬롯
+    auto free_slot = std::find(slot_ids_.begin(), slot_ids_.end(), 0u);
+    if (free_slot == slot_ids_.end())
+        return false;
 
-        users_[user->GetId()] = user;
-        userCount = users_.size();
+    // 인원 수를 먼저 올린다: 그 사이 리퍼가 닫았으면(ROOM_CLOSED) 실패
+    int32_t count = user_count_.load(std::memory_order_acquire);
+    do
+    {
+        if (count == ROOM_CLOSED)
+            return false; // 제거된 방 (참조가 남아 있던 요청)
+    } while (!user_count_.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel));
+
+    const uint16_t slot = static_cast<uint16_t>(free_slot - slot_ids_.begin());
+    slot_ids_[slot] = user->GetId();
+    slot_pos_x_[slot] = 0.0f;
+    slot_pos_y_[slot] = 0.0f;
+    slot_users_[slot] = user;
+    slot_sessions_[slot] = user->GetSessionHandle();
+    if (UsesAoi())
+        aoi_sent_[slot].clear();
+    slot_high_water_ = std::max<uint16_t>(slot_high_water_, slot + 1);
+    user_slots_[user->GetId()] = slot;
+    slot_acked_seq_[slot] = 0;
+    MarkSlotDirty(slot);
+
+    user->JoinRoom(id_, shared_from_this());
+
+    // 첫 입장이면 동면 중이던 틱을 다시 스케줄러에 등록, 아니면 긴 주기에서 깨움
+    if (!tick_registered_)
+    {
+        tick_scheduler_.Register(shared_from_this(), shard_index_);
+        tick_registered_ = true;
+    }
+    else
+    {
+        WakeTick();
+    }
+
+    // 압축 포맷: 새 유저에게는 방 레이아웃/슬롯 전체, 기존 유저에게는 새 슬롯만
+    Session* session = sessions_.Get(slot_sessions_[slot]);
+    if (session && session->GetWireFormat() == WIRE_FORMAT_COMPACT)
+    {
+        SendRoomLayout(*session);
     }
 
-    user->ResetCharacterState();
+    PKT_NOTICE_ROOM_SLOT slot_notice{};
+    slot_notice.pkt_id = NOTICE_ROOM_SLOT;
+    slot_notice.pkt_size = sizeof(PKT_NOTICE_ROOM_SLOT);
+    slot_notice.slot = slot;
+    slot_notice.userId = user->GetId();
+    BroadcastCompact(MakeSendBuffer(&slot_notice, sizeof(slot_notice)), user->GetId());
 
     std::string notification = user->GetUsername() + " joined the room.";
     BroadcastNotification(notification, user->GetId());
+    BroadcastRoomInfo();
 
-    std::cout << "User " << user->GetUsername()
-        << " joined room " << name_
-        << " (Users: " << userCount << ")" << std::endl;
+    LOG_INFO("User %s joined room %s (Users: %zu)",
+        user->GetUsername().c_str(), name_.c_str(), user_slots_.size());
 
     return true;
 }
 
-bool Room::RemoveUser(uint32_t user_id)
+bool Room::RemoveUserOnStrand(uint32_t user_id, bool announce)
 {
-    size_t userCount = 0;
-    std::string username;
+    auto it = user_slots_.find(user_id);
+    if (it == user_slots_.end())
+        return false;
+
+    const uint16_t slot = it->second;
+    user_slots_.erase(it);
+
+    auto user = std::move(slot_users_[slot]);
+    const std::string username = user->GetUsername();
+    user->LeaveRoom(id_);
+
+    slot_ids_[slot] = 0;
+    slot_sessions_[slot] = SlotMap<Session>::INVALID_HANDLE;
+    slot_acked_seq_[slot] = 0;
+    if (UsesAoi())
+        aoi_sent_[slot].clear();
+    MarkSlotDirty(slot);
+    while (slot_high_water_ > 0 && slot_ids_[slot_high_water_ - 1] == 0)
+        --slot_high_water_;
+
+    // 마지막 유저가 나가면 틱 동면 (빈 방은 보낼 대상이 없음)
+    if (user_slots_.empty())
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
+        empty_since_.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+            std::memory_order_relaxed);
+        if (tick_registered_)
+        {
+            tick_scheduler_.Unregister(shared_from_this(), shard_index_);
+            tick_registered_ = false;
+        }
+    }
+    // empty_since_를 먼저 기록하고 0을 공개 (리퍼는 0을 본 뒤 empty_since_를 읽음)
+    user_count_.fetch_sub(1, std::memory_order_acq_rel);
 
-        auto it = users_.find(user_id);
-        if (it == users_.end())
-            return false;
+    PKT_NOTICE_ROOM_SLOT slot_notice{};
+    slot_notice.pkt_id = NOTICE_ROOM_SLOT;
+    slot_notice.pkt_size = sizeof(PKT_NOTICE_ROOM_SLOT);
+    slot_notice.slot = slot;
+    slot_notice.userId = 0;
+    BroadcastCompact(MakeSendBuffer(&slot_notice, sizeof(slot_notice)));
 
-        username = it->second->GetUsername();
-        it->second->ResetCharacterState();
-        users_.erase(it);
-        userCount = users_.size();
+    if (announce)
+    {
+        std::string notification = username + " left the room.";
+        BroadcastNotification(notification, user_id);
+        BroadcastRoomInfo();
     }
 
-    std::string notification = username + " left the room.";
-    BroadcastNotification(notification, user_id);
-    std::cout << "User " << username
-        << " left room " << name_
-        << " (Users: " << userCount << ")" << std::endl;
+    LOG_INFO("User %s left room %s (Users: %zu)",
+        username.c_str(), name_.c_str(), user_slots_.size());
 
     return true;
 }
 
+bool Room::TryClose(std::chrono::steady_clock::time_point now,
+    std::chrono::steady_clock::duration grace)
+{
+    if (user_count_.load(std::memory_order_acquire) != 0)
+        return false;
+
+    const std::chrono::steady_clock::time_point empty_since{
+        std::chrono::steady_clock::duration(empty_since_.load(std::memory_order_relaxed)) };
+    if (now - empty_since < grace)
+        return false;
+
+    int32_t expected = 0;
+    return user_count_.compare_exchange_strong(expected, ROOM_CLOSED, std::memory_order_acq_rel);
+}
+
+void Room::Close()
+{
+    user_count_.store(ROOM_CLOSED, std::memory_order_release);
+
+    auto self = shared_from_this();
+    boost::asio::post(strand_, [self]()
+        {
+            if (self->tick_registered_)
+            {
+                self->tick_scheduler_.Unregister(self, self->shard_index_);
+                self->tick_registered_ = false;
+            }
+        });
+}
+
+void Room::Reinitialize(uint32_t id, const std::string& name, uint32_t max_users)
+{
+    // 풀에서만 꺼내므로 다른 참조가 없음 (strand 밖에서 직접 초기화해도 안전)
+    id_ = id;
+    name_ = name;
+    max_users_ = max_users;
+    user_slots_.clear();
+    ResizeSlots(max_users);
+
+    current_interval_ = tick_config_.base_interval;
+    load_factor_ = 1.0;
+    next_tick_time_ = {};
+    last_broadcast_time_ = {};
+
+    tick_registered_ = false;
+    pinned_ = false;
+    user_count_.store(0, std::memory_order_release);
+    empty_since_.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+        std::memory_order_relaxed);
+}
+
+void Room::ResizeSlots(uint32_t max_users)
+{
+    slot_ids_.assign(max_users, 0);
+    slot_pos_x_.assign(max_users, 0.0f);
+    slot_pos_y_.assign(max_users, 0.0f);
+    slot_dirty_.assign((max_users + 63) / 64, 0);
+    slot_users_.assign(max_users, nullptr);
+    slot_sessions_.assign(max_users, SlotMap<Session>::INVALID_HANDLE);
+    slot_acked_seq_.assign(max_users, 0);
+    slot_high_water_ = 0;
+
+    quantization_.slot_bits = SlotBitsForCapacity(max_users);
+    snapshot_history_.Resize(max_users);
+
+    aoi_sent_.assign(UsesAoi() ? max_users : 0, {});
+    if (UsesAoi())
+    {
+        aoi_grid_.Configure(quantization_.min_x, quantization_.min_y,
+            quantization_.max_x, quantization_.max_y, aoi_.view_radius);
+    }
+}
+
+bool Room::HasDirtySlots() const
+{
+    return std::any_of(slot_dirty_.begin(), slot_dirty_.end(), [](uint64_t bits) { return bits != 0; });
+}
+
+void Room::UpdatePlayerState(uint32_t user_id, const CharacterState& state)
+{
+    auto self = shared_from_this();
+    boost::asio::dispatch(strand_, [self, user_id, state]()
+        {
+            auto it = self->user_slots_.find(user_id);
+            if (it == self->user_slots_.end())
+                return; // 그 사이 퇴장
+
+            const uint16_t slot = it->second;
+            self->slot_pos_x_[slot] = state.pos_x;
+            self->slot_pos_y_[slot] = state.pos_y;
+            self->MarkSlotDirty(slot);
+        });
+}
+
+void Room::AckSnapshot(uint32_t user_id, uint32_t seq)
+{
+    auto self = shared_from_this();
+    boost::asio::dispatch(strand_, [self, user_id, seq]()
+        {
+            auto it = self->user_slots_.find(user_id);
+            if (it == self->user_slots_.end())
+                return; // 그 사이 퇴장
+
+            // ack에는 방 구분이 없으므로 이 방 기록에 있는 것만 기준으로 삼는다
+            // (여러 방에 있는 유저가 다른 방 스냅샷을 확인해도 이 방의 기준은 그대로)
+            if (!self->snapshot_history_.Find(seq))
+                return;
+
+            // 순서가 뒤바뀐 ack는 무시 (앞으로만 진행, 번호가 한 바퀴 돌아도 비교가 맞도록)
+            uint32_t& acked = self->slot_acked_seq_[it->second];
+            if (acked == 0 || IsNewerSequence(seq, acked))
+                acked = seq;
+        });
+}
+
 void Room::BroadcastMessage(PACKET_ID /*pkt_id*/, const void* data, size_t size,
     uint32_t sender_id)
 {
-    std::vector<std::shared_ptr<Session>> targets;
+    Broadcast(MakeSendBuffer(data, size), sender_id);
+}
+
+void Room::Broadcast(SendBufferPtr packet, uint32_t sender_id)
+{
+    if (!packet)
+        return;
+
+    auto self = shared_from_this();
+    boost::asio::dispatch(strand_, [self, packet = std::move(packet), sender_id]()
+        {
+            self->BroadcastOnStrand(packet, sender_id);
+        });
+}
 
+void Room::BroadcastOnStrand(const SendBufferPtr& packet, uint32_t sender_id)
+{
+    for (uint16_t slot = 0; slot < slot_high_water_; ++slot)
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
-        targets.reserve(users_.size());
+        const auto& user = slot_users_[slot];
+        if (!user || (sender_id != 0 && slot_ids_[slot] == sender_id)) continue;
 
-        for (const auto& pair : users_)
+        Session* session = sessions_.Get(slot_sessions_[slot]);
+        if (session && user->IsOnline())
         {
-            if (sender_id != 0 && pair.first == sender_id) continue;
+            session->Send(packet);
+        }
+    }
+}
 
-            auto session = pair.second->GetSession().lock();
-            if (session && pair.second->IsOnline())
-            {
-                targets.push_back(session);
-            }
+void Room::BroadcastRoomInfo()
+{
+    PKT_NOTICE_ROOM_INFO notice{};
+    notice.pkt_id = NOTICE_ROOM_INFO;
+    notice.pkt_size = sizeof(PKT_NOTICE_ROOM_INFO);
+    std::snprintf(notice.roomName, MAX_ROOM_NAME_LEN, "%s", name_.c_str());
+    notice.playerCount = static_cast<std::uint16_t>(user_slots_.size());
+
+    BroadcastOnStrand(MakeSendBuffer(&notice, sizeof(notice)));
+}
+
+void Room::BroadcastCompact(const SendBufferPtr& packet, uint32_t exclude_user_id)
+{
+    if (!packet)
+        return;
+
+    for (uint16_t slot = 0; slot < slot_high_water_; ++slot)
+    {
+        const auto& user = slot_users_[slot];
+        if (!user || slot_ids_[slot] == exclude_user_id)
+            continue;
+
+        Session* session = sessions_.Get(slot_sessions_[slot]);
+        if (session && user->IsOnline() &&
+            session->GetWireFormat() == WIRE_FORMAT_COMPACT)
+        {
+            session->Send(packet);
         }
     }
+}
 
-    for (auto& session : targets)
+void Room::SendRoomLayout(Session& session)
+{
+    PKT_NOTICE_ROOM_LAYOUT layout{};
+    layout.pkt_id = NOTICE_ROOM_LAYOUT;
+    layout.pkt_size = sizeof(PKT_NOTICE_ROOM_LAYOUT);
+    layout.minX = quantization_.min_x;
+    layout.minY = quantization_.min_y;
+    layout.maxX = quantization_.max_x;
+    layout.maxY = quantization_.max_y;
+    layout.positionBits = quantization_.position_bits;
+    layout.slotBits = quantization_.slot_bits;
+    session.SendMessage(&layout, sizeof(layout));
+
+    for (uint16_t slot = 0; slot < slot_high_water_; ++slot)
     {
-        session->SendMessage(data, size);
+        if (slot_ids_[slot] == 0)
+            continue;
+
+        PKT_NOTICE_ROOM_SLOT slot_notice{};
+        slot_notice.pkt_id = NOTICE_ROOM_SLOT;
+        slot_notice.pkt_size = sizeof(PKT_NOTICE_ROOM_SLOT);
+        slot_notice.slot = slot;
+        slot_notice.userId = slot_ids_[slot];
+        session.SendMessage(&slot_notice, sizeof(slot_notice));
     }
 }
 
@@ -94,80 +417,230 @@ void Room::BroadcastNotification(const std::string& notification,
 {
     // SYSTEM 채팅 패킷으로 브로드캐스트
     PKT_NOTICE_CHAT pkt{};
-    pkt.pkt_id = NOTICE_CHAT;
-    pkt.pkt_size = sizeof(PKT_NOTICE_CHAT);
+    MakeNoticeChat(pkt, CHAT_CHANNEL_ROOM, "SYSTEM", notification.c_str(), notification.size());
+
+    BroadcastOnStrand(MakeSendBuffer(&pkt, pkt.pkt_size), exclude_user_id);
+}
+
+void Room::BroadcastPlayerStates(bool force)
+{
+    struct Recipient
+    {
+        Session* session; // 이 핸들러 안에서만 유효 (SlotMap)
+        uint32_t acked_seq;
+        WIRE_FORMAT format;
+    };
+    std::vector<Recipient> recipients;
+
+    // 슬롯 배열을 그대로 복사 (정렬/유저 객체 접근 없음)
+    // 0은 "확인한 스냅샷 없음"이므로 한 바퀴 돌 때 건너뜀
+    if (++next_snapshot_seq_ == 0)
+        ++next_snapshot_seq_;
+    PlayerSnapshot& current = snapshot_history_.Push(next_snapshot_seq_);
+    current.CopyFrom(slot_ids_.data(), slot_pos_x_.data(), slot_pos_y_.data(), slot_high_water_);
+
+    for (uint16_t slot = 0; slot < slot_high_water_; ++slot)
+    {
+        if (slot_ids_[slot] != 0 && IsSlotDirty(slot))
+            LOG_DEBUG("[ID]%u [Pox]%g,%g", slot_ids_[slot], slot_pos_x_[slot], slot_pos_y_[slot]);
+    }
 
-    std::snprintf(pkt.senderName, MAX_NAME_LEN, "%s", "SYSTEM");
-    std::snprintf(pkt.message, MAX_MESSAGE_LEN, "%s", notification.c_str());
+    if (UsesAoi())
+    {
+        BroadcastPlayerStatesAoi(current, force);
+        std::fill(slot_dirty_.begin(), slot_dirty_.end(), 0);
+        return;
+    }
 
-    std::lock_guard<std::mutex> lock(users_mutex_);
-    for (const auto& pair : users_)
+    recipients.reserve(user_slots_.size());
+    for (uint16_t slot = 0; slot < slot_high_water_; ++slot)
     {
-        if (pair.first == exclude_user_id)
+        const auto& user = slot_users_[slot];
+        if (!user)
             continue;
 
-        auto user = pair.second;
-        auto session = user->GetSession().lock();
+        Session* session = sessions_.Get(slot_sessions_[slot]);
         if (session && user->IsOnline())
         {
-            session->SendMessage(&pkt, sizeof(pkt));
+            recipients.push_back({ session, slot_acked_seq_[slot], session->GetWireFormat() });
         }
     }
+    std::fill(slot_dirty_.begin(), slot_dirty_.end(), 0);
+
+    // 같은 포맷 + 같은 기준 스냅샷을 가진 유저끼리는 직렬화한 패킷을 공유 (기준 0 = 전체 스냅샷)
+    struct CachedPacket
+    {
+        WIRE_FORMAT format;
+        uint32_t baseline_seq;
+        SendBufferPtr packet;
+    };
+    std::vector<CachedPacket> packets;
+
+    for (auto& recipient : recipients)
+    {
+        const PlayerSnapshot* baseline = snapshot_history_.Find(recipient.acked_seq);
+        const uint32_t baseline_seq = baseline ? baseline->seq : 0;
 
+        auto it = std::find_if(packets.begin(), packets.end(),
+            [&recipient, baseline_seq](const CachedPacket& cached)
+            {
+                return cached.format == recipient.format && cached.baseline_seq == baseline_seq;
+            });
+
+        if (it == packets.end())
+        {
+            SendBufferPtr packet;
+            if (recipient.format == WIRE_FORMAT_COMPACT)
+            {
+                PKT_NOTICE_PLAYER_STATE_COMPACT pkt;
+                BuildPlayerStateCompact(baseline, current, quantization_, pkt);
+                packet = MakeSendBuffer(&pkt, pkt.pkt_size);
+            }
+            else if (baseline)
+            {
+                PKT_NOTICE_PLAYER_STATE_DELTA pkt;
+                BuildPlayerStateDelta(*baseline, current, pkt);
+                packet = MakeSendBuffer(&pkt, pkt.pkt_size);
+            }
+            else
+            {
+                PKT_NOTICE_PLAYER_STATE pkt;
+                BuildPlayerStateFull(current, pkt);
+                packet = MakeSendBuffer(&pkt, pkt.pkt_size);
+            }
+            it = packets.insert(packets.end(), { recipient.format, baseline_seq, std::move(packet) });
+        }
+        recipient.session->Send(it->packet);
+    }
 }
 
-void Room::BroadcastPlayerStates()
+void Room::BroadcastPlayerStatesAoi(const PlayerSnapshot& current, bool force)
 {
-    PKT_NOTICE_PLAYER_STATE pkt{};
-    pkt.pkt_id = NOTICE_PLAYER_STATE;
-    pkt.count = 0;
+    aoi_grid_.Rebuild(current.ids.data(), current.pos_x.data(), current.pos_y.data(), current.count);
+    const float radius_sq = aoi_.view_radius * aoi_.view_radius;
 
+    for (uint16_t slot = 0; slot < current.count; ++slot)
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
+        const auto& user = slot_users_[slot];
+        if (!user)
+            continue;
 
-        for (const auto& [user_id, user] : users_)
+        Session* session = sessions_.Get(slot_sessions_[slot]);
+        if (!session || !user->IsOnline())
+            continue;
+
+        // 주변 칸에서 반경 안의 플레이어만 (자기 자신 포함)
+        const float x = current.pos_x[slot];
+        const float y = current.pos_y[slot];
+        aoi_candidates_.clear();
+        aoi_grid_.ForEachNear(x, y, [this, &current, x, y, radius_sq](uint16_t other)
+            {
+                const float dx = current.pos_x[other] - x;
+                const float dy = current.pos_y[other] - y;
+                const float dist_sq = dx * dx + dy * dy;
+                if (dist_sq <= radius_sq)
+                    aoi_candidates_.emplace_back(dist_sq, other);
+            });
+
+        // 가까운 순으로 max_visible명까지
+        if (aoi_candidates_.size() > aoi_.max_visible)
         {
-            if (pkt.count >= MAX_PLAYERS_PER_ROOM)
-                break;
-
-            auto& entry = pkt.players[pkt.count];
-            entry.userId = user_id;
-            entry.state = user->GetCharacterState();
-            ++pkt.count;
-            std::cout << "[ID]" << entry.userId << " [Pox]" << entry.state.pos_x << "," << entry.state.pos_y << std::endl;
+            std::nth_element(aoi_candidates_.begin(), aoi_candidates_.begin() + aoi_.max_visible, aoi_candidates_.end());
+            aoi_candidates_.resize(aoi_.max_visible);
         }
-    }
+        std::sort(aoi_candidates_.begin(), aoi_candidates_.end());
+
+        aoi_visible_.clear();
+        for (const auto& candidate : aoi_candidates_)
+            aoi_visible_.push_back(candidate.second);
 
-    pkt.pkt_size = sizeof(PKT_NOTICE_PLAYER_STATE);
+        // 시야 구성이 같고 그 안에서 움직인 사람도 없으면 생략
+        auto& sent = aoi_sent_[slot];
+        bool changed = force || aoi_visible_ != sent;
+        for (std::size_t i = 0; !changed && i < aoi_visible_.size(); ++i)
+            changed = IsSlotDirty(aoi_visible_[i]);
 
-    BroadcastMessage(NOTICE_PLAYER_STATE, &pkt, sizeof(pkt));
+        if (!changed)
+            continue;
+
+        sent = aoi_visible_;
+        SendAoiSnapshot(*session, session->GetWireFormat(), current, aoi_visible_);
+    }
 }
 
-std::vector<std::shared_ptr<User>> Room::GetUserList() const
+void Room::SendAoiSnapshot(Session& session, WIRE_FORMAT format, const PlayerSnapshot& current,
+    const std::vector<uint16_t>& visible)
 {
-    std::lock_guard<std::mutex> lock(users_mutex_);
-    std::vector<std::shared_ptr<User>> user_list;
+    const std::size_t total = visible.size();
+    const auto part_count = static_cast<uint8_t>((total + MAX_PLAYERS_PER_ROOM - 1) / MAX_PLAYERS_PER_ROOM);
 
-    for (const auto& pair : users_)
+    // 모든 조각이 같은 순번: 송신이 밀려 있어도 앞 조각만 최신이 아니라고 버려지지 않는다
+    const uint32_t state_seq = session.ReserveStateSeq();
+
+    for (uint8_t part = 0; part < part_count; ++part)
     {
-        user_list.push_back(pair.second);
+        const std::size_t offset = static_cast<std::size_t>(part) * MAX_PLAYERS_PER_ROOM;
+        const auto count = static_cast<uint16_t>(std::min<std::size_t>(MAX_PLAYERS_PER_ROOM, total - offset));
+
+        if (format == WIRE_FORMAT_COMPACT)
+        {
+            PKT_NOTICE_PLAYER_STATE_COMPACT pkt;
+            BuildPlayerStateCompactPart(current, visible.data() + offset, count, quantization_, part, part_count, pkt);
+            session.SendMessage(&pkt, pkt.pkt_size, state_seq);
+        }
+        else
+        {
+            PKT_NOTICE_PLAYER_STATE pkt;
+            BuildPlayerStatePart(current, visible.data() + offset, count, part, part_count, pkt);
+            session.SendMessage(&pkt, pkt.pkt_size, state_seq);
+        }
     }
+}
+
+void Room::OnSchedulerTick(std::chrono::steady_clock::time_point slot_time,
+    std::chrono::steady_clock::duration lateness)
+{
+    // 아직 이 방의 주기가 안 됨 (주기가 긴 방은 여러 슬롯 주기마다 한 번)
+    if (slot_time < next_tick_time_)
+        return;
+
+    AdaptTickInterval(lateness);
+    next_tick_time_ = slot_time + current_interval_;
 
-    return user_list;
+    // 변화가 없으면 keepalive 주기에만 전송
+    const bool keepalive = slot_time - last_broadcast_time_ >= tick_config_.keepalive_interval;
+    if (keepalive || HasDirtySlots())
+    {
+        BroadcastPlayerStates(keepalive);
+        last_broadcast_time_ = slot_time;
+    }
 }
 
-void Room::ScheduleNextTick()
+void Room::AdaptTickInterval(std::chrono::steady_clock::duration lateness)
 {
-    auto self = shared_from_this();
+    // 서버 부하: 타이머가 늦게 깨어날수록 주기를 늘리고, 여유가 생기면 천천히 되돌린다.
+    const double max_factor = std::max(1.0,
+        static_cast<double>(tick_config_.max_interval.count()) / tick_config_.base_interval.count());
 
-    using namespace std::chrono_literals;
-    tick_timer_.expires_after(50ms); // 수정 예정
-    tick_timer_.async_wait(
-        [self](const boost::system::error_code& ec) {
-            if (ec) return;
+    if (lateness > tick_config_.late_threshold)
+        load_factor_ = std::min(load_factor_ * 1.25, max_factor);
+    else
+        load_factor_ = std::max(1.0, load_factor_ * 0.95);
 
-            self->BroadcastPlayerStates();
+    // 인구: 비었거나 혼자인 방은 다른 사람에게 보여줄 상태가 없으므로 keepalive 주기로 충분
+    if (user_slots_.size() <= 1)
+    {
+        current_interval_ = tick_config_.keepalive_interval;
+    }
+    else
+    {
+        current_interval_ = std::chrono::milliseconds(static_cast<long long>(
+            tick_config_.base_interval.count() * load_factor_));
+    }
+}
 
-            self->ScheduleNextTick();
-        });
+void Room::WakeTick()
+{
+    current_interval_ = tick_config_.base_interval;
+    next_tick_time_ = std::chrono::steady_clock::time_point{};
 }
@@ -1,61 +1,207 @@
 ﻿#pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <string>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
 #include <unordered_map>
 
+#include <boost/asio.hpp>
+
 #include "User.h"
 #include "Protocol.h"
+#include "SendBuffer.h"
+#include "SnapshotHistory.h"
+#include "ServerConfig.h"
+#include "TickScheduler.h"
+#include "AoiGrid.h"
+#include "SlotMap.h"
+
+// 입장/퇴장 결과 콜백 (방 strand에서 호출)
+using RoomResultHandler = std::function<void(bool)>;
 
+// 방은 자기 strand에서만 내부 상태를 만진다 (액터 방식, 락 없음)
+// - 입장/퇴장/브로드캐스트/틱은 모두 strand로 post되고, 결과는 콜백으로 돌려준다.
+// - 다른 쓰레드에서 읽는 값(인원 수, 닫힘 여부)만 atomic.
 class Room : public std::enable_shared_from_this<Room>
 {
 public:
-    Room(boost::asio::io_context& io_context, uint32_t id, const std::string& name, uint32_t max_users = 100)
+    // 방은 shard_index 샤드에 고정 (io_context도 그 샤드의 것)
+    // 세션은 핸들로만 참조 (sessions는 SessionManager의 슬롯 맵)
+    Room(boost::asio::io_context& io_context, TickScheduler& tick_scheduler,
+        const SlotMap<Session>& sessions, std::size_t shard_index,
+        uint32_t id, const std::string& name, uint32_t max_users = 100,
+        const QuantizationParams& quantization = QuantizationParams{},
+        const RoomTickConfig& tick_config = RoomTickConfig{},
+        const AoiConfig& aoi = AoiConfig{})
         : id_(id)
         , name_(name)
         , max_users_(max_users)
-        , io_context_(io_context)
-        , tick_timer_(io_context)
+        , strand_(boost::asio::make_strand(io_context))
+        , tick_scheduler_(tick_scheduler)
+        , sessions_(sessions)
+        , shard_index_(shard_index)
+        , quantization_(quantization)
+        , tick_config_(tick_config)
+        , current_interval_(tick_config.base_interval)
+        , aoi_(aoi)
+        , empty_since_(std::chrono::steady_clock::now().time_since_epoch().count())
     {
+        ResizeSlots(max_users);
     }
-    void StartTick();
+
+    // 풀에서 꺼낸 방을 새 방으로 재사용 (RoomManager만 호출, 아무도 참조하지 않을 때)
+    void Reinitialize(uint32_t id, const std::string& name, uint32_t max_users);
+
+    boost::asio::strand<boost::asio::io_context::executor_type>& GetStrand() { return strand_; }
+
+    // TickScheduler가 이 방의 phase 슬롯마다 strand로 dispatch해서 호출
+    // - slot_time: 슬롯 예정 시각, lateness: 실제로 늦게 깨어난 정도
+    void OnSchedulerTick(std::chrono::steady_clock::time_point slot_time,
+        std::chrono::steady_clock::duration lateness);
+
+    // 플레이어 상태 갱신 (ProcessPlayerState에서 호출, strand에서 슬롯 배열에 기록 후 다음 틱에 브로드캐스트)
+    void UpdatePlayerState(uint32_t user_id, const CharacterState& state);
+
+    // 클라이언트가 확인한 스냅샷 기록 (ProcessSnapshotAck에서 입장한 방마다 호출, 이 방이 보낸 스냅샷만 반영)
+    void AckSnapshot(uint32_t user_id, uint32_t seq);
 
     uint32_t GetId() const { return id_; }
     const std::string& GetName() const { return name_; }
+    std::size_t GetShardIndex() const { return shard_index_; }
 
+    // 고정 방(기본 방)은 비어도 제거하지 않음
+    bool IsPinned() const { return pinned_; }
+    void SetPinned(bool pinned) { pinned_ = pinned; }
+
+    // 빈 지 grace 이상 지났으면 닫고 true (닫힌 방은 입장 불가, RoomManager가 목록에서 제거)
+    // - 아무 쓰레드에서나 호출 가능 (인원 수 0 -> 닫힘을 CAS 한 번으로)
+    bool TryClose(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::duration grace);
+    void Close();
+
+    // strand 밖에서 읽는 인원 수 (방 목록/알림용, 약간 늦을 수 있음)
     size_t GetUserCount() const
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
-        return users_.size();
+        const int32_t count = user_count_.load(std::memory_order_acquire);
+        return count > 0 ? static_cast<size_t>(count) : 0;
     }
 
-    bool AddUser(std::shared_ptr<User> user);
-    bool RemoveUser(uint32_t user_id);
+    // strand로 post, 끝나면 on_complete(성공 여부)
+    void AddUser(std::shared_ptr<User> user, RoomResultHandler on_complete = nullptr);
+    void RemoveUser(uint32_t user_id, RoomResultHandler on_complete = nullptr);
+
+    // 로그아웃/연결 끊김 퇴장: 한꺼번에 몰려온 퇴장은 strand 핸들러 하나에서 모아 처리
+    // (입장 인원 알림/퇴장 메시지도 묶음당 한 번)
+    void QueueDeparture(uint32_t user_id);
 
     // data에는 이미 PACKET_HEADER가 들어 있다고 가정
     void BroadcastMessage(PACKET_ID pkt_id, const void* data, size_t size,
         uint32_t sender_id = 0);
 
+    // 한 번 직렬화한 버퍼를 모든 유저의 송신 큐가 공유 (strand로 dispatch)
+    void Broadcast(SendBufferPtr packet, uint32_t sender_id = 0);
+
+private:
+    static constexpr int32_t ROOM_CLOSED = -1; // user_count_ 값: 제거된 방
+
+    void ResizeSlots(uint32_t max_users);
+    void MarkSlotDirty(uint16_t slot) { slot_dirty_[slot >> 6] |= uint64_t{ 1 } << (slot & 63); }
+    bool IsSlotDirty(uint16_t slot) const { return (slot_dirty_[slot >> 6] >> (slot & 63)) & 1u; }
+    bool HasDirtySlots() const;
+
+    bool AddUserOnStrand(const std::shared_ptr<User>& user);
+    // announce: 퇴장 메시지/인원 알림 전송 (묶음 퇴장은 끝에서 한 번만)
+    bool RemoveUserOnStrand(uint32_t user_id, bool announce = true);
+    void FlushDepartures();
+
+    // 이하 strand 전용
+    void BroadcastOnStrand(const SendBufferPtr& packet, uint32_t sender_id = 0);
     void BroadcastNotification(const std::string& notification,
         uint32_t exclude_user_id);
+    void BroadcastRoomInfo();
 
-    void BroadcastPlayerStates();
+    // 유저별로 확인한 스냅샷 대비 델타(없으면 전체 스냅샷) 전송
+    // - force: 바뀐 게 없어도 전송 (keepalive)
+    void BroadcastPlayerStates(bool force);
 
-    std::vector<std::shared_ptr<User>> GetUserList() const;
+    // 큰 방: 유저마다 시야 안의 플레이어만 가까운 순으로 (여러 패킷으로 나눠서)
+    bool UsesAoi() const { return max_users_ > MAX_PLAYERS_PER_ROOM; }
+    void BroadcastPlayerStatesAoi(const PlayerSnapshot& current, bool force);
+    void SendAoiSnapshot(Session& session, WIRE_FORMAT format, const PlayerSnapshot& current,
+        const std::vector<uint16_t>& visible);
 
-private:
-    void ScheduleNextTick();
+    void AdaptTickInterval(std::chrono::steady_clock::duration lateness);
+
+    // 긴 주기(keepalive)로 자고 있는 틱을 다음 슬롯에 바로 돌도록 (입장 시)
+    void WakeTick();
+
+    // 압축 포맷 유저에게만 전송 (슬롯 배정 알림 등)
+    void BroadcastCompact(const SendBufferPtr& packet, uint32_t exclude_user_id = 0);
+    void SendRoomLayout(Session& session);
+
+    // 스냅샷 번호 시작값 (OS 난수)
+    static uint32_t RandomSnapshotSeqStart();
 
     uint32_t id_;
     std::string name_;
     uint32_t max_users_;
-    std::unordered_map<uint32_t, std::shared_ptr<User>> users_;
-    mutable std::mutex users_mutex_;
 
-    boost::asio::io_context& io_context_;
-    boost::asio::steady_timer tick_timer_;
+    // 플레이어 상태는 슬롯 인덱스 SoA로 방이 소유 (strand 전용)
+    // - slot_ids_[slot] == 0이면 빈 슬롯, 스냅샷은 [0, slot_high_water_) 구간을 그대로 복사
+    std::vector<uint32_t> slot_ids_;
+    std::vector<float> slot_pos_x_;
+    std::vector<float> slot_pos_y_;
+    std::vector<uint64_t> slot_dirty_;                 // 마지막 브로드캐스트 이후 바뀐 슬롯 비트
+    std::vector<std::shared_ptr<User>> slot_users_;
+    std::vector<SessionHandle> slot_sessions_;          // 입장 시점의 세션 핸들 (틱마다 참조 카운트 없이 조회)
+    std::vector<uint32_t> slot_acked_seq_;              // 그 유저가 이 방에서 마지막으로 확인한 스냅샷 (델타 기준), 0이면 없음
+    uint16_t slot_high_water_ = 0;                     // 사용 중인 가장 큰 슬롯 + 1
+    std::unordered_map<uint32_t, uint16_t> user_slots_; // userId -> 슬롯 번호
+
+    // user_slots_.size()의 복사본 (strand 밖 읽기용), ROOM_CLOSED면 닫힘
+    std::atomic<int32_t> user_count_{ 0 };
+
+    // 처리 대기 중인 묶음 퇴장 (아무 쓰레드에서나 추가, strand에서 비움)
+    std::vector<uint32_t> pending_departures_;
+    bool departure_flush_posted_ = false;
+    std::mutex departures_mutex_;
+
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+
+    // 빈 방은 스케줄러에서 빠져 있다 (strand 전용)
+    TickScheduler& tick_scheduler_;
+    const SlotMap<Session>& sessions_;
+    std::size_t shard_index_;
+    bool tick_registered_ = false;
+
+    // 최근 상태 스냅샷 (strand 전용)
+    // - 번호는 방마다 따로 세고, 시작값을 방마다 난수로 달리해서 다른 방의 최근 번호와 겹치지 않게 한다
+    SnapshotHistory snapshot_history_;
+    uint32_t next_snapshot_seq_ = RandomSnapshotSeqStart(); // 마지막으로 쓴 번호
+
+    // 압축 포맷 좌표 범위/비트 수
+    QuantizationParams quantization_;
+
+    // 틱 주기 (strand 전용)
+    RoomTickConfig tick_config_;
+    std::chrono::milliseconds current_interval_;
+    double load_factor_ = 1.0;
+    std::chrono::steady_clock::time_point next_tick_time_{};
+    std::chrono::steady_clock::time_point last_broadcast_time_{};
+
+    // 관심 영역 (큰 방만, strand 전용)
+    AoiConfig aoi_;
+    AoiGrid aoi_grid_;
+    std::vector<std::vector<uint16_t>> aoi_sent_;            // 수신 슬롯별로 지난번에 보낸 시야
+    std::vector<std::pair<float, uint16_t>> aoi_candidates_; // (거리 제곱, 슬롯) 틱마다 재사용
+    std::vector<uint16_t> aoi_visible_;
+
+    // 수명 관리 (pinned_는 생성 시에만 설정)
+    bool pinned_ = false;
+    std::atomic<std::chrono::steady_clock::rep> empty_since_;
 
 };
@@ -1,112 +1,209 @@
 ﻿#pragma once
 
 #include <mutex>
+#include <algorithm>
 #include <atomic>
-#include <unordered_map>
+#include <string>
 #include <vector>
-#include <iostream>
+#include <chrono>
+#include <boost/asio.hpp>
 
 #include "Room.h"
+#include "IoContextPool.h"
+#include "TickScheduler.h"
+#include "ServerConfig.h"
+#include "ShardedMap.h"
+#include "SlotMap.h"
+#include "Logger.h"
 
 class RoomManager
 {
 public:
-    RoomManager(boost::asio::io_context& io_context) 
-        : next_room_id_(1)
-        , io_context_(io_context) 
+    RoomManager(IoContextPool& io_pool, TickScheduler& tick_scheduler,
+        const SlotMap<Session>& sessions, const ServerConfig& config)
+        : io_pool_(io_pool)
+        , tick_scheduler_(tick_scheduler)
+        , sessions_(sessions)
+        , quantization_(config.quantization)
+        , tick_config_(config.room_tick)
+        , lifecycle_(config.room_lifecycle)
+        , aoi_(config.aoi)
+        , next_room_id_(1)
+        , reap_timer_(io_pool.GetIoContext(0))
     {
     }
 
-    std::shared_ptr<Room> CreateRoom( const std::string& name, uint32_t max_users = 100)
+    // pinned: 비어도 제거하지 않는 방 (서버 기본 방)
+    // 같은 이름의 방이 이미 있으면 nullptr
+    std::shared_ptr<Room> CreateRoom( const std::string& name, uint32_t max_users = 100, bool pinned = false)
     {
         uint32_t room_id = next_room_id_++;
-        auto room = std::make_shared<Room>(io_context_, room_id, name, max_users);
-        
-        room->StartTick();
- 
+        auto room = AcquireRoom(room_id, name, max_users);
+        room->SetPinned(pinned);
+
+        // 이름 인덱스에 먼저 등록 (중복 확인과 예약을 한 번에)
+        if (!rooms_by_name_.TryInsert(name, room))
         {
-            std::lock_guard<std::mutex> lock(rooms_mutex_);
-            rooms_[room_id] = room;
+            ReleaseRoom(std::move(room));
+            return nullptr;
         }
-        
 
-        std::cout << "Room created: " << name << " (ID: " << room_id << ")" << std::endl;
+        // 빈 방은 틱을 돌지 않음: 첫 입장 때 Room이 스케줄러에 등록
+        rooms_.InsertOrAssign(room_id, room);
+
+        LOG_INFO("Room created: %s (ID: %u)", name.c_str(), room_id);
         return room;
     }
 
     std::shared_ptr<Room> GetRoom(uint32_t room_id)
     {
-        std::lock_guard<std::mutex> lock(rooms_mutex_);
-        auto it = rooms_.find(room_id);
-        return (it != rooms_.end()) ? it->second : nullptr;
+        return rooms_.Find(room_id);
     }
 
     std::shared_ptr<Room> GetRoomByName(const std::string& name)
     {
-        std::lock_guard<std::mutex> lock(rooms_mutex_);
-        for (const auto& pair : rooms_)
-        {
-            if (pair.second->GetName() == name)
-                return pair.second;
-        }
-        return nullptr;
+        return rooms_by_name_.Find(name);
     }
 
     bool RemoveRoom(uint32_t room_id)
     {
-        std::lock_guard<std::mutex> lock(rooms_mutex_);
-        auto it = rooms_.find(room_id);
-        if (it != rooms_.end())
-        {
-            std::cout << "Room removed: " << it->second->GetName()
-                << " (ID: " << room_id << ")" << std::endl;
-            rooms_.erase(it);
-            return true;
-        }
-        return false;
+        auto room = rooms_.Extract(room_id);
+        if (!room)
+            return false;
+
+        LOG_INFO("Room removed: %s (ID: %u)", room->GetName().c_str(), room_id);
+        UnindexName(room);
+        room->Close();
+        ReleaseRoom(std::move(room));
+        return true;
     }
 
+    // 방 ID 순 (오래된 방, 기본 방이 먼저)
     std::vector<std::shared_ptr<Room>> GetRoomList()
     {
-        std::lock_guard<std::mutex> lock(rooms_mutex_);
         std::vector<std::shared_ptr<Room>> room_list;
+        room_list.reserve(rooms_.Size());
+        rooms_.ForEach([&room_list](uint32_t, const std::shared_ptr<Room>& room) { room_list.push_back(room); });
 
-        for (const auto& pair : rooms_)
-        {
-            room_list.push_back(pair.second);
-        }
-
+        std::sort(room_list.begin(), room_list.end(),
+            [](const std::shared_ptr<Room>& lhs, const std::shared_ptr<Room>& rhs) { return lhs->GetId() < rhs->GetId(); });
         return room_list;
     }
 
     size_t GetRoomCount() const
     {
-        std::lock_guard<std::mutex> lock(rooms_mutex_);
-        return rooms_.size();
+        return rooms_.Size();
     }
 
+    // 빈 채로 grace 기간이 지난 방(고정 방 제외)을 제거하고 객체는 풀로 반납
     void CleanupEmptyRooms()
     {
-        std::lock_guard<std::mutex> lock(rooms_mutex_);
+        const auto now = std::chrono::steady_clock::now();
 
-        for (auto it = rooms_.begin(); it != rooms_.end();)
+        // 후보만 모아두고 샤드 락 밖에서 닫는다 (TryClose가 CAS라 그 사이 입장한 방은 닫히지 않음)
+        std::vector<std::shared_ptr<Room>> candidates;
+        rooms_.ForEach([&candidates](uint32_t, const std::shared_ptr<Room>& room)
+            {
+                if (!room->IsPinned() && room->GetUserCount() == 0)
+                    candidates.push_back(room);
+            });
+
+        for (auto& room : candidates)
         {
-            if (it->second->GetUserCount() == 0)
+            if (!room->TryClose(now, lifecycle_.reap_grace))
+                continue;
+
+            LOG_INFO("Removing empty room: %s", room->GetName().c_str());
+            rooms_.Erase(room->GetId());
+            UnindexName(room);
+            ReleaseRoom(std::move(room));
+        }
+    }
+
+    // 주기적으로 CleanupEmptyRooms 실행 (샤드 0 타이머)
+    void StartReaper()
+    {
+        boost::asio::post(reap_timer_.get_executor(), [this]() { ScheduleReap(); });
+    }
+
+    void StopReaper()
+    {
+        reaper_stopped_ = true;
+        boost::asio::post(reap_timer_.get_executor(), [this]() { reap_timer_.cancel(); });
+    }
+
+private:
+    void ScheduleReap()
+    {
+        if (reaper_stopped_)
+            return;
+
+        reap_timer_.expires_after(std::max<std::chrono::steady_clock::duration>(
+            std::min<std::chrono::steady_clock::duration>(lifecycle_.reap_check_interval, lifecycle_.reap_grace),
+            std::chrono::seconds(1)));
+        reap_timer_.async_wait([this](const boost::system::error_code& ec)
             {
-                std::cout << "Removing empty room: " << it->second->GetName() << std::endl;
-                it = rooms_.erase(it);
-            }
-            else
+                if (ec)
+                    return;
+
+                CleanupEmptyRooms();
+                ScheduleReap();
+            });
+    }
+
+    // 풀에 아무도 참조하지 않는 방이 있으면 재사용, 없으면 새로 만든다
+    std::shared_ptr<Room> AcquireRoom(uint32_t room_id, const std::string& name, uint32_t max_users)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+
+            // use_count가 1이면 풀만 들고 있음 (스케줄러에 보낸 Unregister 등 남은 참조가 모두 끝남)
+            auto it = std::find_if(room_pool_.begin(), room_pool_.end(),
+                [](const std::shared_ptr<Room>& room) { return room.use_count() == 1; });
+            if (it != room_pool_.end())
             {
-                ++it;
+                auto room = std::move(*it);
+                room_pool_.erase(it);
+                room->Reinitialize(room_id, name, max_users);
+                return room;
             }
         }
+
+        // 방도 샤드 하나에 고정되고, 틱은 그 샤드의 스케줄러 슬롯에서 돈다
+        const std::size_t shard = io_pool_.NextIndex();
+        return std::make_shared<Room>(io_pool_.GetIoContext(shard), tick_scheduler_, sessions_, shard,
+            room_id, name, max_users, quantization_, tick_config_, aoi_);
     }
 
-private:
-    boost::asio::io_context& io_context_;
-    std::unordered_map<uint32_t, std::shared_ptr<Room>> rooms_;
-    mutable std::mutex rooms_mutex_;
+    void UnindexName(const std::shared_ptr<Room>& room)
+    {
+        rooms_by_name_.EraseIf(room->GetName(),
+            [&room](const std::shared_ptr<Room>& indexed) { return indexed == room; });
+    }
+
+    void ReleaseRoom(std::shared_ptr<Room> room)
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (room_pool_.size() < lifecycle_.pool_capacity)
+            room_pool_.push_back(std::move(room));
+    }
+
+    IoContextPool& io_pool_;
+    TickScheduler& tick_scheduler_;
+    const SlotMap<Session>& sessions_;
+    QuantizationParams quantization_;
+    RoomTickConfig tick_config_;
+    RoomLifecycleConfig lifecycle_;
+    AoiConfig aoi_;
+    ShardedMap<uint32_t, std::shared_ptr<Room>> rooms_;
+    ShardedMap<std::string, std::shared_ptr<Room>> rooms_by_name_; // 방 이름 -> 방
     std::atomic<uint32_t> next_room_id_;
+
+    // 제거된 방 객체 재사용 풀
+    std::vector<std::shared_ptr<Room>> room_pool_;
+    std::mutex pool_mutex_;
+
+    boost::asio::steady_timer reap_timer_;
+    std::atomic<bool> reaper_stopped_{ false };
     
 };
@@ -0,0 +1,122 @@
+﻿#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+
+#include "Protocol.h"
+
+// 직렬화가 끝난 송신 패킷 (불변)
+// - 브로드캐스트 시 한 번만 만들고, 받는 세션들의 송신 큐가 shared_ptr로 같이 참조한다.
+// - 패킷 최대 크기가 정해져 있으므로 allocate_shared 한 번(제어 블록 + 데이터)으로 할당이 끝나고,
+//   그 블록은 쓰레드별 캐시에서 꺼내고 돌려준다 (패킷마다 new/delete 하지 않음).
+class SendBuffer
+{
+public:
+    SendBuffer(const void* data, std::size_t size)
+        : size_(size)
+    {
+        std::memcpy(data_.data(), data, size);
+    }
+
+    const char* Data() const { return data_.data(); }
+    std::size_t Size() const { return size_; }
+
+    PACKET_ID GetPacketId() const
+    {
+        return static_cast<PACKET_ID>(reinterpret_cast<const PACKET_HEADER*>(data_.data())->pkt_id);
+    }
+
+    boost::asio::const_buffer AsBuffer() const
+    {
+        return boost::asio::buffer(data_.data(), size_);
+    }
+
+private:
+    std::size_t size_;
+    std::array<char, MAX_RECEIVE_BUFFER_LEN> data_;
+};
+
+using SendBufferPtr = std::shared_ptr<const SendBuffer>;
+
+namespace send_buffer_detail
+{
+    // 제어 블록 + SendBuffer가 들어가는 크기 (이보다 큰 요청은 캐시를 거치지 않음)
+    constexpr std::size_t BLOCK_SIZE = sizeof(SendBuffer) + 64;
+    constexpr std::size_t BLOCK_CACHE_LIMIT = 1024; // 쓰레드당 보관할 최대 블록 수
+
+    struct BlockCache
+    {
+        std::vector<void*> free_blocks;
+
+        ~BlockCache()
+        {
+            for (void* block : free_blocks)
+                ::operator delete(block);
+        }
+    };
+
+    inline BlockCache& LocalBlockCache()
+    {
+        thread_local BlockCache cache;
+        return cache;
+    }
+
+    // 블록은 만든 쓰레드(방 틱 등)가 아니라 마지막 참조를 놓은 쓰레드(세션 샤드)의 캐시로 돌아간다
+    template <typename T>
+    class RecyclingAllocator
+    {
+    public:
+        using value_type = T;
+
+        RecyclingAllocator() = default;
+
+        template <typename U>
+        RecyclingAllocator(const RecyclingAllocator<U>&) noexcept {}
+
+        T* allocate(std::size_t count)
+        {
+            if (sizeof(T) * count > BLOCK_SIZE)
+                return static_cast<T*>(::operator new(sizeof(T) * count));
+
+            auto& cache = LocalBlockCache();
+            if (cache.free_blocks.empty())
+                return static_cast<T*>(::operator new(BLOCK_SIZE));
+
+            void* block = cache.free_blocks.back();
+            cache.free_blocks.pop_back();
+            return static_cast<T*>(block);
+        }
+
+        void deallocate(T* pointer, std::size_t count)
+        {
+            auto& cache = LocalBlockCache();
+            if (sizeof(T) * count > BLOCK_SIZE || cache.free_blocks.size() >= BLOCK_CACHE_LIMIT)
+            {
+                ::operator delete(pointer);
+                return;
+            }
+            cache.free_blocks.push_back(pointer);
+        }
+
+        template <typename U>
+        bool operator==(const RecyclingAllocator<U>&) const noexcept { return true; }
+
+        template <typename U>
+        bool operator!=(const RecyclingAllocator<U>&) const noexcept { return false; }
+    };
+}
+
+// 크기가 올바르지 않으면 nullptr
+inline SendBufferPtr MakeSendBuffer(const void* data, std::size_t size)
+{
+    if (size < sizeof(PACKET_HEADER) || size > MAX_RECEIVE_BUFFER_LEN)
+        return nullptr;
+
+    return std::allocate_shared<const SendBuffer>(send_buffer_detail::RecyclingAllocator<SendBuffer>(), data, size);
+}
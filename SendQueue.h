@@ -0,0 +1,132 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "SendBuffer.h"
+
+// ===== 세션 송신 큐 (락 없는 intrusive MPSC) =====
+// - 방 틱/채팅 등 여러 샤드 쓰레드가 Push하고, 세션 샤드 쓰레드 하나만 Pop한다.
+// - Push는 atomic exchange 한 번 + store 한 번이라 절대 블록되지 않는다.
+// - 노드는 쓰레드별 캐시에서 꺼내고 돌려준다 (패킷마다 new/delete 하지 않음).
+
+struct SendNode
+{
+    std::atomic<SendNode*> next{ nullptr };
+    SendBufferPtr packet;
+    std::uint32_t state_seq = 0; // 상태 스냅샷이면 세션 안에서의 적재 순번, 아니면 0
+    std::uint32_t target = 0;    // UDP 채널 큐: 받을 세션 핸들
+};
+
+namespace send_queue_detail
+{
+    constexpr std::size_t NODE_CACHE_LIMIT = 1024; // 쓰레드당 보관할 최대 노드 수
+
+    struct NodeCache
+    {
+        std::vector<SendNode*> free_nodes;
+
+        ~NodeCache()
+        {
+            for (SendNode* node : free_nodes)
+                delete node;
+        }
+    };
+
+    inline NodeCache& LocalNodeCache()
+    {
+        thread_local NodeCache cache;
+        return cache;
+    }
+}
+
+inline SendNode* AcquireSendNode()
+{
+    auto& cache = send_queue_detail::LocalNodeCache();
+    if (cache.free_nodes.empty())
+        return new SendNode();
+
+    SendNode* node = cache.free_nodes.back();
+    cache.free_nodes.pop_back();
+    return node;
+}
+
+// 노드는 생산자 쓰레드에서 할당되고 세션 샤드에서 반납되므로, 캐시가 넘치면 그냥 해제
+inline void ReleaseSendNode(SendNode* node)
+{
+    node->packet.reset();
+    node->state_seq = 0;
+    node->target = 0;
+
+    auto& cache = send_queue_detail::LocalNodeCache();
+    if (cache.free_nodes.size() < send_queue_detail::NODE_CACHE_LIMIT)
+        cache.free_nodes.push_back(node);
+    else
+        delete node;
+}
+
+// Vyukov 방식 intrusive MPSC 큐 (stub 노드 하나로 비어 있는 상태를 표현)
+class SendQueue
+{
+public:
+    SendQueue() = default;
+    SendQueue(const SendQueue&) = delete;
+    SendQueue& operator=(const SendQueue&) = delete;
+
+    // 아무 쓰레드
+    void Push(SendNode* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        SendNode* prev = head_.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // 소비자 쓰레드 전용: 비었거나 생산자가 연결을 끝내기 직전이면 nullptr
+    SendNode* Pop()
+    {
+        SendNode* tail = tail_;
+        SendNode* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &stub_)
+        {
+            if (!next)
+                return nullptr;
+
+            tail_ = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next)
+        {
+            tail_ = next;
+            return tail;
+        }
+
+        if (tail != head_.load(std::memory_order_acquire))
+            return nullptr; // Push 도중 (다음 Pop에서 꺼내짐)
+
+        // 마지막 노드: stub을 뒤에 붙여서 떼어낸다
+        Push(&stub_);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next)
+        {
+            tail_ = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    // 소비자 쓰레드 전용: Push 중인 노드가 있으면 false
+    bool Empty() const
+    {
+        return tail_ == &stub_ && head_.load(std::memory_order_acquire) == &stub_;
+    }
+
+private:
+    SendNode stub_;
+    std::atomic<SendNode*> head_{ &stub_ };
+    SendNode* tail_ = &stub_;
+};
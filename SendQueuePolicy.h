@@ -0,0 +1,39 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Logger.h"
+
+// 세션 송신 큐 한도 (느린 클라이언트 보호)
+struct SendQueueLimits
+{
+    // 소프트 한도: 넘으면 패킷 종류별 정책 적용
+    std::size_t max_bytes = 64 * 1024;
+    std::size_t max_packets = 256;
+
+    // 큐가 이만큼 쌓이면 채팅은 버림
+    std::size_t chat_drop_bytes = 32 * 1024;
+
+    // 하드 한도: 넘으면 연결 종료
+    std::size_t hard_cap_bytes = 256 * 1024;
+};
+
+// 송신 큐 정책이 발동한 횟수 (서버 전체 누적)
+struct SendQueueStats
+{
+    std::atomic<std::uint64_t> state_replaced{ 0 };   // 오래된 상태 스냅샷을 최신 것으로 교체
+    std::atomic<std::uint64_t> chat_dropped{ 0 };     // 채팅 드롭
+    std::atomic<std::uint64_t> overflow_enqueued{ 0 }; // 소프트 한도 초과 상태에서 그대로 적재 (응답 등)
+    std::atomic<std::uint64_t> disconnected{ 0 };     // 하드 한도 초과로 연결 종료
+
+    void Report() const
+    {
+        LOG_INFO("SendQueue stats - state replaced: %llu, chat dropped: %llu, overflow enqueued: %llu, disconnected: %llu",
+            static_cast<unsigned long long>(state_replaced.load()),
+            static_cast<unsigned long long>(chat_dropped.load()),
+            static_cast<unsigned long long>(overflow_enqueued.load()),
+            static_cast<unsigned long long>(disconnected.load()));
+    }
+};
@@ -0,0 +1,185 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "Protocol.h"
+#include "SendQueuePolicy.h"
+#include "BitPacking.h"
+#include "Logger.h"
+
+// 방 틱 주기 설정
+struct RoomTickConfig
+{
+    std::chrono::milliseconds base_interval{ 50 };       // 평상시 틱 주기
+    std::chrono::milliseconds max_interval{ 200 };       // 서버 부하 시 늘어날 수 있는 최대 주기
+    std::chrono::milliseconds keepalive_interval{ 1000 }; // 변화가 없어도 이 주기로는 상태 전송
+    std::chrono::milliseconds late_threshold{ 10 };      // 이만큼 늦게 깨어나면 과부하로 판단
+};
+
+// 큰 방(정원 > MAX_PLAYERS_PER_ROOM)의 관심 영역 설정
+struct AoiConfig
+{
+    float view_radius = 64.0f;       // 이 거리 안의 플레이어만 전송
+    std::uint16_t max_visible = 64; // 유저당 한 틱에 보내는 최대 인원 (가까운 순)
+};
+
+// 방 수명 관리 설정 (플레이어가 만든 방만 해당, 기본 방은 고정)
+struct RoomLifecycleConfig
+{
+    std::chrono::seconds reap_grace{ 30 };          // 빈 채로 이만큼 지나면 방 제거
+    std::chrono::seconds reap_check_interval{ 5 };  // 빈 방 검사 주기
+    std::size_t pool_capacity = 32;                 // 재사용을 위해 보관할 Room 객체 수
+};
+
+// 서버 실행 옵션
+// 사용법: FixerServer [--threads N] [--pin]
+//                      [--send-queue-bytes N] [--send-queue-packets N] [--send-queue-hard-cap N]
+//                      [--position-bits N] [--room-bounds F]
+//                      [--tick-ms N] [--tick-max-ms N] [--keepalive-ms N]
+//                      [--room-grace-sec N] [--room-pool N]
+//                      [--view-radius F] [--max-visible N]
+//                      [--log-level debug|info|warn|error] [--stats-sec N] [--udp] [--port N]
+struct ServerConfig
+{
+    // TCP 대기 포트 (0이면 OS가 빈 포트 배정, 테스트용)
+    std::uint16_t port = PORT_NUMBER;
+
+    // I/O 샤드(쓰레드) 수, 0이면 코어 수만큼
+    std::size_t io_thread_count = 0;
+
+    // 샤드 쓰레드를 코어에 고정할지 여부 (리눅스 전용)
+    bool pin_io_threads = false;
+
+    // 세션별 송신 큐 한도
+    SendQueueLimits send_queue_limits;
+
+    // 압축 상태 포맷 좌표 범위(방 공통)/정밀도
+    QuantizationParams quantization;
+
+    // 방 틱 주기
+    RoomTickConfig room_tick;
+
+    // 빈 방 제거/재사용
+    RoomLifecycleConfig room_lifecycle;
+
+    // 큰 방 관심 영역
+    AoiConfig aoi;
+
+    // 상태 스냅샷용 UDP 채널 (UDP_PORT_NUMBER), 꺼져 있으면 전부 TCP
+    bool udp_enabled = false;
+
+    // 런타임 로그 레벨 (컴파일 레벨 FIXER_LOG_LEVEL보다 낮은 로그는 이미 빠져 있음)
+    LogLevel log_level = static_cast<LogLevel>(FIXER_LOG_LEVEL);
+
+    // 송신 큐/틱/UDP 통계를 로그로 남기는 주기, 0이면 종료할 때만
+    std::chrono::seconds stats_report_interval{ 60 };
+
+    std::size_t ResolveIoThreadCount() const
+    {
+        if (io_thread_count != 0)
+            return io_thread_count;
+
+        const unsigned int cores = std::thread::hardware_concurrency();
+        return cores != 0 ? cores : 1;
+    }
+
+    static ServerConfig FromArgs(int argc, char* argv[])
+    {
+        ServerConfig config;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            {
+                config.io_thread_count = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--pin") == 0)
+            {
+                config.pin_io_threads = true;
+            }
+            else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+            {
+                config.port = static_cast<std::uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--send-queue-bytes") == 0 && i + 1 < argc)
+            {
+                config.send_queue_limits.max_bytes = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--send-queue-packets") == 0 && i + 1 < argc)
+            {
+                config.send_queue_limits.max_packets = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--send-queue-hard-cap") == 0 && i + 1 < argc)
+            {
+                config.send_queue_limits.hard_cap_bytes = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--position-bits") == 0 && i + 1 < argc)
+            {
+                const unsigned long bits = std::strtoul(argv[++i], nullptr, 10);
+                config.quantization.position_bits = static_cast<std::uint8_t>(bits < 2 ? 2 : (bits > 16 ? 16 : bits));
+            }
+            else if (std::strcmp(argv[i], "--tick-ms") == 0 && i + 1 < argc)
+            {
+                config.room_tick.base_interval = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--tick-max-ms") == 0 && i + 1 < argc)
+            {
+                config.room_tick.max_interval = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--keepalive-ms") == 0 && i + 1 < argc)
+            {
+                config.room_tick.keepalive_interval = std::chrono::milliseconds(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--room-grace-sec") == 0 && i + 1 < argc)
+            {
+                config.room_lifecycle.reap_grace = std::chrono::seconds(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--room-pool") == 0 && i + 1 < argc)
+            {
+                config.room_lifecycle.pool_capacity = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--view-radius") == 0 && i + 1 < argc)
+            {
+                const float radius = std::strtof(argv[++i], nullptr);
+                if (radius > 0.0f)
+                    config.aoi.view_radius = radius;
+            }
+            else if (std::strcmp(argv[i], "--max-visible") == 0 && i + 1 < argc)
+            {
+                const unsigned long count = std::strtoul(argv[++i], nullptr, 10);
+                config.aoi.max_visible = static_cast<std::uint16_t>(count < 1 ? 1 : (count > 1024 ? 1024 : count));
+            }
+            else if (std::strcmp(argv[i], "--log-level") == 0 && i + 1 < argc)
+            {
+                const char* level = argv[++i];
+                if (std::strcmp(level, "debug") == 0) config.log_level = LogLevel::Debug;
+                else if (std::strcmp(level, "info") == 0) config.log_level = LogLevel::Info;
+                else if (std::strcmp(level, "warn") == 0) config.log_level = LogLevel::Warn;
+                else if (std::strcmp(level, "error") == 0) config.log_level = LogLevel::Error;
+            }
+            else if (std::strcmp(argv[i], "--stats-sec") == 0 && i + 1 < argc)
+            {
+                config.stats_report_interval = std::chrono::seconds(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (std::strcmp(argv[i], "--udp") == 0)
+            {
+                config.udp_enabled = true;
+            }
+            else if (std::strcmp(argv[i], "--room-bounds") == 0 && i + 1 < argc)
+            {
+                const float bound = std::strtof(argv[++i], nullptr);
+                if (bound > 0.0f)
+                {
+                    config.quantization.min_x = config.quantization.min_y = -bound;
+                    config.quantization.max_x = config.quantization.max_y = bound;
+                }
+            }
+        }
+
+        return config;
+    }
+};
@@ -1,25 +1,70 @@
 ﻿#include "Session.h"
 #include "GameServer.h"
 #include "Protocol.h"
+#include "Logger.h"
 
 #include <cstring>
 
-using boost::asio::async_read;
 using boost::asio::async_write;
+using boost::asio::awaitable;
 using boost::asio::buffer;
+using boost::asio::redirect_error;
+using boost::asio::use_awaitable;
 using boost::system::error_code;
 
+namespace
+{
+    // 최신 것만 의미 있는 상태 스냅샷 (델타도 확인된 기준 대비이므로 새 것이 옛 것을 대체 가능)
+    bool IsStateSnapshotPacket(PACKET_ID pkt_id)
+    {
+        return pkt_id == NOTICE_PLAYER_STATE ||
+            pkt_id == NOTICE_PLAYER_STATE_DELTA ||
+            pkt_id == NOTICE_PLAYER_STATE_COMPACT;
+    }
+
+    // vector를 그대로 넘기면 쓰기 작업이 버퍼 목록을 복사(힙 할당)하므로 포인터 두 개짜리 범위로 넘긴다
+    // (전송이 끝날 때까지 write_buffers_는 그대로)
+    struct ConstBufferRange
+    {
+        using value_type = boost::asio::const_buffer;
+        using const_iterator = const boost::asio::const_buffer*;
+
+        const_iterator first;
+        const_iterator last;
+
+        const_iterator begin() const { return first; }
+        const_iterator end() const { return last; }
+    };
+}
+
 Session::Session(tcp::socket socket, GameServer& server)
     : socket_(std::move(socket))
     , server_(server)
+    , udp_channel_(server.GetUdpChannel())
+    , send_limits_(server.GetConfig().send_queue_limits)
+    , send_stats_(server.GetSendQueueStats())
+    , write_wakeup_(socket_.get_executor(), boost::asio::steady_timer::time_point::max())
 {
+    write_buffers_.reserve(SESSION_SEND_BATCH_COUNT);
+    in_flight_.reserve(SESSION_SEND_BATCH_COUNT);
 }
 
-Session::~Session() = default;
+Session::~Session()
+{
+    // 남은 노드 반납 (마지막 참조가 사라질 때라 다른 쓰레드가 Push하지 않음)
+    for (SendNode* node : in_flight_)
+        ReleaseSendNode(node);
+    if (carry_)
+        ReleaseSendNode(carry_);
+    while (SendNode* node = send_queue_.Pop())
+        ReleaseSendNode(node);
+}
 
 void Session::Start()
 {
-    DoReadHeader();
+    auto self = shared_from_this();
+    boost::asio::co_spawn(socket_.get_executor(), ReadLoop(self), boost::asio::detached);
+    boost::asio::co_spawn(socket_.get_executor(), WriteLoop(self), boost::asio::detached);
 }
 
 void Session::Disconnect()
@@ -28,102 +73,76 @@ void Session::Disconnect()
     if (!is_disconnected_.compare_exchange_strong(expected, true))
         return; // 이미 끊긴 상태
 
-    error_code ec;
-    try
-    {
-        socket_.shutdown(tcp::socket::shutdown_both, ec);
-        socket_.close(ec);
-    }
-    catch (...)
-    {
-        // 무시
-    }
+    // 소켓과 타이머는 세션 샤드에서만 건드림 (다른 쓰레드에서 부르면 진행 중인 읽기/쓰기와 경합)
+    // - 닫아서 대기 중인 읽기를 끝내고, 대기 중인 쓰기 코루틴도 끝나도록 깨움
+    auto self = shared_from_this();
+    boost::asio::post(socket_.get_executor(), [self]()
+        {
+            error_code ec;
+            self->socket_.shutdown(tcp::socket::shutdown_both, ec);
+            self->socket_.close(ec);
+            self->WakeWriteLoop();
+        });
 
     // GameServer에게 세션 종료 알림
-    server_.OnSessionDisconnected(shared_from_this());
+    server_.OnSessionDisconnected(self);
 }
 
-void Session::DoReadHeader()
+awaitable<void> Session::ReadLoop(std::shared_ptr<Session> self)
 {
-    if (IsDisconnected())
-        return;
+    error_code ec;
+    while (!IsDisconnected())
+    {
+        const std::size_t bytes_transferred = co_await socket_.async_read_some(
+            recv_buffer_.WritableBuffer(), WithHandlerMemory(read_handler_memory_, redirect_error(use_awaitable, ec)));
 
-    auto self = shared_from_this();
-    async_read(
-        socket_,
-        buffer(&read_header_, sizeof(PACKET_HEADER)),
-        [this, self](const error_code& ec, std::size_t bytes_transferred)
+        if (ec || bytes_transferred == 0)
         {
-            if (ec || bytes_transferred != sizeof(PACKET_HEADER))
-            {
-                Disconnect();
-                return;
-            }
+            Disconnect();
+            co_return;
+        }
 
-            // 헤더 검증
-            if (read_header_.pkt_size < sizeof(PACKET_HEADER) ||
-                read_header_.pkt_size > MAX_RECEIVE_BUFFER_LEN)
-            {
-                std::cout << "Invalid packet size: "
-                    << read_header_.pkt_size << std::endl;
-                Disconnect();
-                return;
-            }
+        recv_buffer_.CommitWrite(bytes_transferred);
 
-            const std::size_t body_size =
-                static_cast<std::size_t>(read_header_.pkt_size) - sizeof(PACKET_HEADER);
-            read_body_.resize(body_size);
+        if (!ProcessReceivedPackets())
+        {
+            Disconnect();
+            co_return;
+        }
 
-            if (body_size == 0)
-            {
-                // 바디가 없는 패킷
-                std::vector<char> packet(read_header_.pkt_size);
-                std::memcpy(packet.data(), &read_header_, sizeof(PACKET_HEADER));
-                ProcessPacket(packet.data(), packet.size());
-                DoReadHeader();
-            }
-            else
-            {
-                DoReadBody(body_size);
-            }
-        });
+        recv_buffer_.Compact();
+    }
 }
 
-void Session::DoReadBody(std::size_t body_size)
+// 버퍼에 완성된 패킷이 있는 만큼 복사 없이 그 자리에서 처리
+bool Session::ProcessReceivedPackets()
 {
-    if (IsDisconnected())
-        return;
+    while (recv_buffer_.ReadableSize() >= sizeof(PACKET_HEADER))
+    {
+        const char* data = recv_buffer_.ReadPtr();
+        const auto& header = *reinterpret_cast<const PACKET_HEADER*>(data);
 
-    auto self = shared_from_this();
-    async_read(
-        socket_,
-        buffer(read_body_.data(), body_size),
-        [this, self](const error_code& ec, std::size_t bytes_transferred)
+        // 헤더 검증
+        if (header.pkt_size < sizeof(PACKET_HEADER) ||
+            header.pkt_size > MAX_RECEIVE_BUFFER_LEN)
         {
-            if (ec || bytes_transferred != read_body_.size())
-            {
-                Disconnect();
-                return;
-            }
+            LOG_WARN("Invalid packet size: %u", static_cast<unsigned int>(header.pkt_size));
+            return false;
+        }
 
-            // 헤더 + 바디를 하나의 패킷 버퍼로 합치기
-            const std::size_t packet_size =
-                sizeof(PACKET_HEADER) + read_body_.size();
+        // 아직 바디가 다 안 들어옴
+        if (recv_buffer_.ReadableSize() < header.pkt_size)
+            break;
 
-            std::vector<char> packet(packet_size);
-            std::memcpy(packet.data(), &read_header_, sizeof(PACKET_HEADER));
-            if (!read_body_.empty())
-            {
-                std::memcpy(packet.data() + sizeof(PACKET_HEADER),
-                    read_body_.data(),
-                    read_body_.size());
-            }
+        const std::size_t packet_size = header.pkt_size;
+        ProcessPacket(data, packet_size);
+        recv_buffer_.ConsumeRead(packet_size);
 
-            ProcessPacket(packet.data(), packet.size());
+        if (IsDisconnected())
+            return true;
+    }
 
-            // 다음 패킷 읽기
-            DoReadHeader();
-        });
+    return true;
 }
 
 void Session::ProcessPacket(const char* data, std::size_t size)
@@ -137,100 +156,217 @@ void Session::ProcessPacket(const char* data, std::size_t size)
     if (header.pkt_size != size ||
         header.pkt_size > MAX_RECEIVE_BUFFER_LEN)
     {
-        std::cout << "Packet size mismatch. header: "
-            << header.pkt_size
-            << ", actual: " << size << std::endl;
+        LOG_WARN("Packet size mismatch. header: %u, actual: %zu",
+            static_cast<unsigned int>(header.pkt_size), size);
         return;
     }
 
     // GamerServer의 Dispatcher을 반환하여, 패킷에 대한 정보를 전달
     server_.GetPacketDispatcher().DispatchPacket(
-        shared_from_this(), header, data, size);
+        *this, header, data, size);
 }
 
-void Session::SendMessage(const void* data, std::size_t size)
+void Session::SendMessage(const void* data, std::size_t size, std::uint32_t state_seq)
 {
     if (IsDisconnected())
         return;
 
-    if (size > MAX_RECEIVE_BUFFER_LEN)
+    auto packet = MakeSendBuffer(data, size);
+    if (!packet)
     {
-        std::cout << "SendMessage size too big: " << size << std::endl;
+        LOG_WARN("SendMessage invalid size: %zu", size);
         return;
     }
 
-    std::vector<char> buffer_copy(
-        static_cast<const char*>(data),
-        static_cast<const char*>(data) + size);
+    Send(std::move(packet), state_seq);
+}
+
+void Session::Send(SendBufferPtr packet, std::uint32_t state_seq)
+{
+    if (IsDisconnected() || !packet)
+        return;
+
+    // 상태 스냅샷은 UDP 채널이 연결돼 있으면 그쪽으로 (유실돼도 다음 틱이 대체하므로 TCP 큐에 쌓지 않음)
+    if (udp_channel_ && IsUdpBound() && IsStateSnapshotPacket(packet->GetPacketId()))
+    {
+        udp_channel_->Send(handle_, std::move(packet));
+        return;
+    }
 
-    bool should_start_write = false;
+    bool overflow_disconnect = false;
+    if (!EnqueueWithPolicy(packet, state_seq, overflow_disconnect))
     {
-        std::lock_guard<std::mutex> lock(write_mutex_);
-        write_queue_.emplace_back(std::move(buffer_copy));
-        if (!write_in_progress_)
+        if (overflow_disconnect)
         {
-            write_in_progress_ = true;
-            should_start_write = true;
+            // 브로드캐스트 중(방 strand 등)일 수 있으므로 종료는 세션 샤드에서 처리
+            auto self = shared_from_this();
+            boost::asio::post(socket_.get_executor(), [self]()
+                {
+                    self->Disconnect();
+                });
         }
+        return;
     }
 
-    if (should_start_write)
+    // 적재를 먼저 공개한 뒤 플래그 확인 (ReleaseWriteFlag의 반대 순서와 짝)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!write_in_progress_.exchange(true, std::memory_order_acq_rel))
     {
-        DoWrite();
+        // 방 틱 등 다른 샤드 쓰레드에서 호출될 수 있으므로 쓰기 코루틴은 세션 샤드에서 깨움
+        auto self = shared_from_this();
+        boost::asio::dispatch(socket_.get_executor(), MakeAllocatingHandler(wake_write_memory_, [self]()
+            {
+                self->WakeWriteLoop();
+            }));
     }
 }
 
-void Session::DoWrite()
+// 생산자 쓰레드에서 락 없이 호출 (한도 확인은 근사치: 동시에 들어온 패킷만큼 조금 넘을 수 있음)
+bool Session::EnqueueWithPolicy(SendBufferPtr& packet, std::uint32_t state_seq, bool& overflow_disconnect)
 {
-    if (IsDisconnected())
-        return;
+    const std::size_t size = packet->Size();
+    const std::size_t queued_bytes = queued_bytes_.load(std::memory_order_relaxed);
+
+    // 하드 한도: 더 쌓지 않고 연결 종료
+    if (queued_bytes + size > send_limits_.hard_cap_bytes)
+    {
+        overflow_disconnect = true;
+        ++send_stats_.disconnected;
+        return false;
+    }
 
-    std::vector<char> packet_to_send;
+    const PACKET_ID pkt_id = packet->GetPacketId();
+    const bool is_state = IsStateSnapshotPacket(pkt_id);
 
+    if (pkt_id == NOTICE_CHAT && queued_bytes + size > send_limits_.chat_drop_bytes)
     {
-        std::lock_guard<std::mutex> lock(write_mutex_);
-        if (write_queue_.empty())
-        {
-            write_in_progress_ = false;
-            return;
-        }
+        ++send_stats_.chat_dropped;
+        return false;
+    }
 
-        packet_to_send = write_queue_.front();
+    // 상태 스냅샷은 그대로 넣고, 밀려 있으면 CollectWriteBatch가 최신 것만 보낸다 (큐 안에서 교체하지 않음)
+    const bool over_soft_limit =
+        queued_bytes + size > send_limits_.max_bytes ||
+        queued_packets_.load(std::memory_order_relaxed) >= send_limits_.max_packets;
+    if (over_soft_limit && !is_state)
+    {
+        ++send_stats_.overflow_enqueued;
     }
 
-    auto self = shared_from_this();
-    async_write(
-        socket_,
-        buffer(packet_to_send.data(), packet_to_send.size()),
-        [this, self](const error_code& ec, std::size_t /*bytes_transferred*/)
+    SendNode* node = AcquireSendNode();
+    node->packet = std::move(packet);
+    node->state_seq = !is_state ? 0 : (state_seq != 0 ? state_seq : ReserveStateSeq());
+
+    queued_bytes_.fetch_add(size, std::memory_order_relaxed);
+    queued_packets_.fetch_add(1, std::memory_order_relaxed);
+    send_queue_.Push(node);
+    return true;
+}
+
+void Session::ReleaseQueued(SendNode* node)
+{
+    queued_bytes_.fetch_sub(node->packet->Size(), std::memory_order_relaxed);
+    queued_packets_.fetch_sub(1, std::memory_order_relaxed);
+    ReleaseSendNode(node);
+}
+
+// 큐에 쌓인 패킷을 예산만큼 모아 한 번의 scatter/gather 쓰기로 전송 (세션 샤드)
+// - write_in_progress_가 true인 동안만 큐를 비우고, 비면 플래그를 내린 뒤 타이머에서 잠든다.
+awaitable<void> Session::WriteLoop(std::shared_ptr<Session> self)
+{
+    error_code ec;
+    while (!IsDisconnected())
+    {
+        CollectWriteBatch();
+
+        if (in_flight_.empty())
         {
-            if (ec)
+            if (ReleaseWriteFlag())
             {
-                Disconnect();
-                return;
+                // Push 도중인 노드면 곧 연결되므로 핸들러를 한 번 양보하고 다시 시도
+                co_await boost::asio::post(socket_.get_executor(), use_awaitable);
+                continue;
             }
 
-            bool has_more = false;
-            {
-                std::lock_guard<std::mutex> lock(write_mutex_);
-                if (!write_queue_.empty())
-                {
-                    write_queue_.pop_front();
-                }
+            write_wakeup_.expires_at(boost::asio::steady_timer::time_point::max());
+            co_await write_wakeup_.async_wait(WithHandlerMemory(write_wait_memory_, redirect_error(use_awaitable, ec)));
+            continue;
+        }
 
-                if (!write_queue_.empty())
-                {
-                    has_more = true;
-                }
-                else
-                {
-                    write_in_progress_ = false;
-                }
-            }
+        co_await async_write(socket_, ConstBufferRange{ write_buffers_.data(), write_buffers_.data() + write_buffers_.size() },
+            WithHandlerMemory(write_handler_memory_, redirect_error(use_awaitable, ec)));
 
-            if (has_more && !IsDisconnected())
-            {
-                DoWrite();
-            }
-        });
+        // 이번에 보낸 패킷 전부 반납
+        for (SendNode* node : in_flight_)
+            ReleaseQueued(node);
+        in_flight_.clear();
+
+        if (ec)
+        {
+            Disconnect();
+            co_return;
+        }
+    }
+}
+
+void Session::CollectWriteBatch()
+{
+    // 밀려 있을 때는 최신이 아닌 상태 스냅샷을 건너뜀 (뒤에 더 새 것이 있음)
+    // - 최신 순번은 한 번만 읽고 그보다 오래된 것만 버린다: 모으는 도중 새로 들어온 스냅샷의 앞 조각을 버리지 않도록
+    // - 이미 일부 조각을 보낸 스냅샷은 나머지도 보낸다
+    const bool over_soft_limit =
+        queued_bytes_.load(std::memory_order_relaxed) > send_limits_.max_bytes ||
+        queued_packets_.load(std::memory_order_relaxed) > send_limits_.max_packets;
+    const std::uint32_t latest_state_seq = state_seq_.load(std::memory_order_acquire);
+
+    // 노드가 패킷을 붙잡고 있으므로 전송이 끝날 때까지 버퍼가 유효함
+    write_buffers_.clear();
+    std::size_t batch_bytes = 0;
+    while (in_flight_.size() < SESSION_SEND_BATCH_COUNT)
+    {
+        SendNode* node = carry_ ? carry_ : send_queue_.Pop();
+        carry_ = nullptr;
+        if (!node)
+            break;
+
+        if (over_soft_limit && node->state_seq != 0 && node->state_seq != sending_state_seq_ &&
+            IsNewerSequence(latest_state_seq, node->state_seq))
+        {
+            ReleaseQueued(node);
+            ++send_stats_.state_replaced;
+            continue;
+        }
+
+        const std::size_t size = node->packet->Size();
+        if (!in_flight_.empty() && batch_bytes + size > SESSION_SEND_BATCH_LEN)
+        {
+            carry_ = node;
+            break;
+        }
+
+        if (node->state_seq != 0)
+            sending_state_seq_ = node->state_seq;
+
+        in_flight_.push_back(node);
+        write_buffers_.emplace_back(node->packet->AsBuffer());
+        batch_bytes += size;
+    }
+}
+
+bool Session::ReleaseWriteFlag()
+{
+    write_in_progress_.store(false, std::memory_order_release);
+
+    // Send는 적재 -> 플래그 순, 여기는 플래그 -> 큐 확인 순: 둘 중 하나는 반드시 상대를 본다
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (send_queue_.Empty())
+        return false;
+
+    // 여기서 못 가져갔으면 가져간 Send 쪽이 WakeWriteLoop를 보낸다
+    return !write_in_progress_.exchange(true, std::memory_order_acq_rel);
+}
+
+void Session::WakeWriteLoop()
+{
+    write_wakeup_.cancel();
 }
@@ -1,17 +1,33 @@
 ﻿#pragma once
 
-#include <deque>
 #include <vector>
 #include <memory>
-#include <mutex>
 #include <atomic>
-#include <iostream>
 
 #include <boost/asio.hpp>
 
 #include "Protocol.h"
+#include "RecvBuffer.h"
+#include "SendBuffer.h"
+#include "SendQueue.h"
+#include "HandlerAllocator.h"
+#include "SendQueuePolicy.h"
 
 class GameServer; // 전방 선언
+class UdpChannel;
+
+// SlotMap<Session>/SlotMap<User> 핸들 (0이면 없음)
+using SessionHandle = std::uint32_t;
+using UserHandle = std::uint32_t;
+
+// UDP 채널 샤드에서만 읽고 쓰는 세션별 UDP 상태
+struct UdpPeerState
+{
+    boost::asio::ip::udp::endpoint endpoint; // 마지막으로 유효한 데이터그램을 보낸 주소
+    std::uint64_t secret = 0;                // 이 상태를 만든 토큰 비밀값 (재로그인하면 새로 시작)
+    std::uint32_t last_recv_seq = 0;
+    std::uint32_t next_send_seq = 0;
+};
 
 class Session : public std::enable_shared_from_this<Session>
 {
@@ -21,14 +37,23 @@ public:
     Session(tcp::socket socket, GameServer& server);
     ~Session();
 
-    // 세션 시작 (읽기 루프 시작)
+    // 세션 시작 (읽기/쓰기 코루틴 시작)
     void Start();
 
-    // 연결 종료 (중복 호출 방지)
+    // 연결 종료 (중복 호출 방지, 아무 쓰레드: 소켓 정리는 세션 샤드로 넘김)
     void Disconnect();
 
     // 패킷(메시지) 전송 – GameServer / Room에서 사용
-    void SendMessage(const void* data, std::size_t size);
+    void SendMessage(const void* data, std::size_t size, std::uint32_t state_seq = 0);
+
+    // 이미 직렬화된 공유 버퍼 전송 (브로드캐스트용, 복사 없음)
+    // - 아무 쓰레드에서나 호출 가능, 락 없이 큐에 넣고 바로 돌아온다 (방 틱을 막지 않음)
+    // - state_seq: 상태 스냅샷 순번, 0이면 새로 받는다.
+    //   여러 패킷으로 나눈 스냅샷은 ReserveStateSeq()로 하나 받아 모든 조각에 넘긴다 (밀려도 통째로 남거나 통째로 버려짐)
+    void Send(SendBufferPtr packet, std::uint32_t state_seq = 0);
+
+    // 상태 스냅샷 순번 하나 예약 (이보다 먼저 받은 순번의 스냅샷은 밀려 있을 때 버려진다)
+    std::uint32_t ReserveStateSeq() { return state_seq_.fetch_add(1, std::memory_order_acq_rel) + 1; }
 
     // 소켓 직접 접근용 (GameServer에서 async_accept에 사용)
     tcp::socket& GetSocket() { return socket_; }
@@ -38,34 +63,103 @@ public:
     uint32_t GetUserId() const { return user_id_; }
     void SetUserId(uint32_t id) { user_id_ = id; }
 
+    // 로그인된 유저 핸들 (패킷 처리에서 유저 조회용)
+    UserHandle GetUserHandle() const { return user_handle_; }
+    void SetUserHandle(UserHandle handle) { user_handle_ = handle; }
+
+    // SessionManager에 등록될 때 받은 자기 핸들
+    SessionHandle GetHandle() const { return handle_; }
+    void SetHandle(SessionHandle handle) { handle_ = handle; }
+
     // 인증 여부
     bool IsAuthenticated() const { return is_authenticated_; }
     void SetAuthenticated(bool v) { is_authenticated_ = v; }
 
     bool IsDisconnected() const { return is_disconnected_; }
 
+    // 로그인 시 협상한 상태 패킷 포맷
+    WIRE_FORMAT GetWireFormat() const { return wire_format_.load(std::memory_order_relaxed); }
+    void SetWireFormat(WIRE_FORMAT format) { wire_format_.store(format, std::memory_order_relaxed); }
+
+    // ===== UDP 상태 채널 =====
+    // 로그인 때 발급한 토큰 비밀값 (0이면 UDP 사용 안 함)
+    std::uint64_t GetUdpSecret() const { return udp_secret_.load(std::memory_order_acquire); }
+    void SetUdpSecret(std::uint64_t secret) { udp_secret_.store(secret, std::memory_order_release); }
+
+    // 유효한 데이터그램을 받아 클라이언트 주소를 알게 되면 true: 이후 상태 스냅샷은 UDP로 보낸다
+    bool IsUdpBound() const { return udp_bound_.load(std::memory_order_acquire); }
+    void SetUdpBound(bool bound) { udp_bound_.store(bound, std::memory_order_release); }
+
+    // UdpChannel 샤드 전용
+    UdpPeerState& GetUdpPeer() { return udp_peer_; }
+
 private:
-    void DoReadHeader();
-    void DoReadBody(std::size_t body_size);
+    // 세션마다 코루틴 프레임 하나씩: self를 프레임에 들고 있으므로 작업마다 클로저를 만들지 않는다
+    boost::asio::awaitable<void> ReadLoop(std::shared_ptr<Session> self);
+    boost::asio::awaitable<void> WriteLoop(std::shared_ptr<Session> self);
+
+    bool ProcessReceivedPackets();
     void ProcessPacket(const char* data, std::size_t size);
 
-    void DoWrite();
+    // 큐에서 이번에 보낼 묶음을 in_flight_/write_buffers_에 채움 (세션 샤드)
+    void CollectWriteBatch();
+
+    // 보낼 것이 없을 때 쓰기 플래그를 내림. 그 사이 새 패킷이 들어와서 다시 가져왔으면 true
+    bool ReleaseWriteFlag();
+
+    // 대기 중인 쓰기 코루틴 깨우기 (세션 샤드)
+    void WakeWriteLoop();
+
+    // 소프트 한도 초과 시 패킷 종류별 정책, 적재했으면 true
+    bool EnqueueWithPolicy(SendBufferPtr& packet, std::uint32_t state_seq, bool& overflow_disconnect);
+
+    // 전송했거나 버린 노드 반납 (큐 크기 갱신)
+    void ReleaseQueued(SendNode* node);
 
 private:
     tcp::socket socket_;
     GameServer& server_;
+    UdpChannel* udp_channel_; // --udp로 켰을 때만
+    const SendQueueLimits& send_limits_;
+    SendQueueStats& send_stats_;
 
     // 수신 버퍼
-    PACKET_HEADER read_header_{};
-    std::vector<char> read_body_;
+    RecvBuffer recv_buffer_;
 
-    // 송신 큐
-    std::mutex write_mutex_;
-    std::deque<std::vector<char>> write_queue_;
-    bool write_in_progress_ = false;
+    // 쓰기 코루틴이 보낼 것이 없을 때 기다리는 타이머 (만료 없이 cancel로만 깨움)
+    boost::asio::steady_timer write_wakeup_;
+
+    // 읽기/쓰기/쓰기 대기 작업 메모리 (각각 한 번에 하나만 진행되므로 재사용)
+    HandlerMemory read_handler_memory_;
+    HandlerMemory write_handler_memory_;
+    HandlerMemory write_wait_memory_;
+
+    // 깨우기 핸들러 메모리: write_in_progress_를 true로 바꾼 쪽만 쓰므로 한 번에 하나
+    // (다른 쓰레드에서 할당해도 반납이 플래그 해제보다 먼저라 순서가 보장됨)
+    HandlerMemory wake_write_memory_;
+
+    // 송신 큐 (생산자 여럿, 소비자는 세션 샤드)
+    SendQueue send_queue_;
+    std::atomic<std::size_t> queued_bytes_{ 0 };    // 큐 + 전송 중인 패킷 크기 합
+    std::atomic<std::size_t> queued_packets_{ 0 };
+    std::atomic<std::uint32_t> state_seq_{ 0 };     // 마지막으로 적재한 상태 스냅샷 순번
+    std::atomic<bool> write_in_progress_{ true };   // false면 쓰기 코루틴이 대기 중, true로 바꾼 쪽이 깨움
+
+    // 현재 전송 중인 묶음 (세션 샤드에서만 접근)
+    std::vector<SendNode*> in_flight_;
+    std::vector<boost::asio::const_buffer> write_buffers_;
+    SendNode* carry_ = nullptr; // 이번 묶음에 못 들어가서 다음 묶음 맨 앞으로 가는 노드
+    std::uint32_t sending_state_seq_ = 0; // 마지막으로 묶음에 넣은 상태 스냅샷 순번 (나머지 조각은 버리지 않음)
 
     // 세션 상태
     uint32_t user_id_ = 0;
+    UserHandle user_handle_ = 0;
+    SessionHandle handle_ = 0;
     std::atomic<bool> is_authenticated_{ false };
     std::atomic<bool> is_disconnected_{ false };
+    std::atomic<WIRE_FORMAT> wire_format_{ WIRE_FORMAT_DEFAULT };
+
+    std::atomic<std::uint64_t> udp_secret_{ 0 };
+    std::atomic<bool> udp_bound_{ false };
+    UdpPeerState udp_peer_;
 };
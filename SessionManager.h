@@ -1,69 +1,149 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
-#include <unordered_set>
-#include <iostream>
+#include <vector>
+
+#include <boost/asio.hpp>
 
 #include "Session.h"
+#include "SendBuffer.h"
+#include "IoContextPool.h"
+#include "ShardedMap.h"
+#include "SlotMap.h"
+#include "Logger.h"
 
 class SessionManager
 {
 public:
+    using SessionList = std::vector<std::shared_ptr<Session>>;
+
+    // 전체 브로드캐스트 한 묶음(핸들러 하나)에서 보내는 세션 수
+    static constexpr std::size_t BROADCAST_BATCH_SIZE = 256;
+
+    explicit SessionManager(IoContextPool& io_pool)
+        : handles_(io_pool)
+    {
+    }
+
     void AddSession(std::shared_ptr<Session> session)
     {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        sessions_.insert(session);
-        std::cout << "Session added. Total sessions: " << sessions_.size() << std::endl;
+        Session* key = session.get();
+        session->SetHandle(handles_.Insert(session));
+        sessions_.InsertOrAssign(key, std::move(session));
+        InvalidateSnapshot();
+        LOG_INFO("Session added. Total sessions: %zu", sessions_.Size());
+    }
+
+    void RemoveSession(const std::shared_ptr<Session>& session)
+    {
+        if (session->GetUserId() != 0)
+            UnbindUser(session->GetUserId(), *session);
+
+        handles_.Remove(session->GetHandle());
+        sessions_.Erase(session.get());
+        InvalidateSnapshot();
+        LOG_INFO("Session removed. Total sessions: %zu", sessions_.Size());
     }
 
-    void RemoveSession(std::shared_ptr<Session> session)
+    // 로그인 성공 시 userId 인덱스에 등록 / 로그아웃 시 해제
+    void BindUser(uint32_t user_id, std::shared_ptr<Session> session)
     {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        sessions_.erase(session);
-        std::cout << "Session removed. Total sessions: " << sessions_.size() << std::endl;
+        sessions_by_user_.InsertOrAssign(user_id, std::move(session));
     }
 
+    void UnbindUser(uint32_t user_id, const Session& session)
+    {
+        sessions_by_user_.EraseIf(user_id,
+            [&session](const std::shared_ptr<Session>& indexed) { return indexed.get() == &session; });
+    }
+
+    // 방 브로드캐스트 등에서 핸들로 조회 (포인터는 현재 핸들러 안에서만 유효)
+    const SlotMap<Session>& GetHandles() const { return handles_; }
+
     std::shared_ptr<Session> FindSessionByUserId(uint32_t user_id)
     {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        for (auto& session : sessions_)
+        return sessions_by_user_.Find(user_id);
+    }
+
+    // 세션 목록 스냅샷 (세션이 추가/제거된 뒤 처음 요청할 때만 다시 만든다)
+    std::shared_ptr<const SessionList> GetSnapshot()
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        const std::uint64_t version = version_.load(std::memory_order_acquire);
+        if (!snapshot_ || snapshot_version_ != version)
         {
-            if (session->GetUserId() == user_id)
-                return session;
+            auto sessions = std::make_shared<SessionList>();
+            sessions->reserve(sessions_.Size());
+            sessions_.ForEach([&sessions](Session*, const std::shared_ptr<Session>& session) { sessions->push_back(session); });
+            snapshot_ = std::move(sessions);
+            snapshot_version_ = version;
         }
-        return nullptr;
+        return snapshot_;
     }
 
-    void BroadcastToAll(const void* data, size_t size)
+    // 이미 직렬화된 패킷을 인증된 모든 세션에 전송
+    // - 락은 스냅샷을 꺼낼 때만 잡고, 실제 전송은 BROADCAST_BATCH_SIZE개씩 나눠서 샤드들에 post
+    void BroadcastToAll(SendBufferPtr packet, IoContextPool& io_pool)
     {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        for (auto& session : sessions_)
+        if (!packet)
+            return;
+
+        auto sessions = GetSnapshot();
+        for (std::size_t begin = 0; begin < sessions->size(); begin += BROADCAST_BATCH_SIZE)
         {
-            if (session->IsAuthenticated())
-            {
-                session->SendMessage(data, size);
-            }
+            const std::size_t end = std::min(begin + BROADCAST_BATCH_SIZE, sessions->size());
+            boost::asio::post(io_pool.GetNextIoContext(), [sessions, packet, begin, end]()
+                {
+                    for (std::size_t i = begin; i < end; ++i)
+                    {
+                        const auto& session = (*sessions)[i];
+                        if (session->IsAuthenticated())
+                            session->Send(packet);
+                    }
+                });
         }
     }
 
     size_t GetSessionCount() const
     {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        return sessions_.size();
+        return sessions_.Size();
     }
 
     void DisconnectAll()
     {
-        std::lock_guard<std::mutex> lock(sessions_mutex_);
-        for (auto& session : sessions_)
-        {
+        // Disconnect가 RemoveSession을 다시 부르므로 샤드 락 밖(스냅샷)에서 끊는다
+        auto sessions = GetSnapshot();
+        for (const auto& session : *sessions)
             session->Disconnect();
-        }
-        sessions_.clear();
+
+        sessions_.Clear();
+        sessions_by_user_.Clear();
+        InvalidateSnapshot();
     }
 
 private:
-    std::unordered_set<std::shared_ptr<Session>> sessions_;
-    mutable std::mutex sessions_mutex_;
+    // 목록이 바뀌면 버전을 올리고 캐시된 스냅샷도 버림
+    // (다음 전체 브로드캐스트 전까지 끊긴 세션을 붙잡고 있지 않도록)
+    void InvalidateSnapshot()
+    {
+        std::shared_ptr<const SessionList> stale;
+        {
+            std::lock_guard<std::mutex> lock(snapshot_mutex_);
+            version_.fetch_add(1, std::memory_order_release);
+            stale = std::move(snapshot_);
+        }
+    }
+
+    ShardedMap<Session*, std::shared_ptr<Session>> sessions_;
+    ShardedMap<uint32_t, std::shared_ptr<Session>> sessions_by_user_; // userId -> 세션 (로그인한 세션만)
+    SlotMap<Session> handles_;
+
+    // 전체 브로드캐스트용 스냅샷 (sessions_가 바뀔 때마다 version_ 증가)
+    std::atomic<std::uint64_t> version_{ 0 };
+    std::shared_ptr<const SessionList> snapshot_;
+    std::uint64_t snapshot_version_ = 0;
+    std::mutex snapshot_mutex_;
 };
@@ -0,0 +1,133 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// 여러 샤드로 나눈 동시성 해시 맵 (매니저들의 ID/이름 인덱스용)
+// - 키 해시로 샤드를 고르고 그 샤드의 락만 잡으므로, 서로 다른 키의 조회/삽입은 거의 경합하지 않는다.
+// - 조회는 평균 O(1). 전체 순회(ForEach)는 샤드를 하나씩 잠그므로 맵 전체의 순간 스냅샷은 아니다.
+// - Value는 shared_ptr처럼 복사가 싼 타입을 가정 (Find는 값을 복사해서 반환, 없으면 Value{}).
+template <typename Key, typename Value, typename Hash = std::hash<Key>, std::size_t ShardCount = 32>
+class ShardedMap
+{
+    static_assert(ShardCount != 0 && (ShardCount & (ShardCount - 1)) == 0, "ShardCount must be a power of two");
+
+public:
+    ShardedMap() = default;
+    ShardedMap(const ShardedMap&) = delete;
+    ShardedMap& operator=(const ShardedMap&) = delete;
+
+    // 키가 없을 때만 삽입 (이미 있으면 false, 이름 중복 확인과 등록을 한 번에)
+    bool TryInsert(const Key& key, Value value)
+    {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.map.emplace(key, std::move(value)).second)
+            return false;
+
+        size_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void InsertOrAssign(const Key& key, Value value)
+    {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.map.insert_or_assign(key, std::move(value)).second)
+            size_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Value Find(const Key& key) const
+    {
+        const Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        return it != shard.map.end() ? it->second : Value{};
+    }
+
+    // 꺼내면서 제거 (없으면 Value{})
+    Value Extract(const Key& key)
+    {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end())
+            return Value{};
+
+        Value value = std::move(it->second);
+        shard.map.erase(it);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return value;
+    }
+
+    // pred(value)가 true일 때만 제거 (같은 키에 다른 값이 다시 등록된 경우를 지우지 않도록)
+    template <typename Pred>
+    bool EraseIf(const Key& key, Pred&& pred)
+    {
+        Shard& shard = ShardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end() || !pred(it->second))
+            return false;
+
+        shard.map.erase(it);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool Erase(const Key& key)
+    {
+        return EraseIf(key, [](const Value&) { return true; });
+    }
+
+    // 샤드 락을 잡은 채로 fn(key, value) 호출 (fn 안에서 같은 맵을 건드리지 말 것)
+    template <typename Fn>
+    void ForEach(Fn&& fn) const
+    {
+        for (const Shard& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const auto& pair : shard.map)
+                fn(pair.first, pair.second);
+        }
+    }
+
+    void Clear()
+    {
+        for (Shard& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            size_.fetch_sub(shard.map.size(), std::memory_order_relaxed);
+            shard.map.clear();
+        }
+    }
+
+    std::size_t Size() const { return size_.load(std::memory_order_relaxed); }
+
+private:
+    // 샤드마다 다른 캐시 라인 (락 경합이 이웃 샤드로 번지지 않도록)
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<Key, Value, Hash> map;
+    };
+
+    // 맵 내부 버킷은 해시 하위 비트를 쓰므로 샤드는 섞은 뒤 상위 비트로 고른다
+    static std::size_t ShardIndex(const Key& key)
+    {
+        const std::uint64_t mixed = static_cast<std::uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(mixed >> 32) & (ShardCount - 1);
+    }
+
+    Shard& ShardFor(const Key& key) { return shards_[ShardIndex(key)]; }
+    const Shard& ShardFor(const Key& key) const { return shards_[ShardIndex(key)]; }
+
+    std::array<Shard, ShardCount> shards_;
+    std::atomic<std::size_t> size_{ 0 };
+};
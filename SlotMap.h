@@ -0,0 +1,172 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "IoContextPool.h"
+
+// 세대 번호가 붙은 32비트 핸들로 객체를 가리키는 슬롯 맵 (세션/유저용)
+// - 핸들 = 세대(상위 12비트) | 슬롯 번호(하위 20비트), 0은 무효 핸들
+// - Get은 락 없이 범위 확인 + 세대 비교만 하고 raw 포인터를 돌려준다 (shared_ptr 참조 카운트 없음).
+// - Remove는 세대를 올려서 기존 핸들을 바로 무효화하고, 객체 해제와 슬롯 재사용은 모든 샤드가
+//   지금 돌고 있는 핸들러를 끝낸 뒤로 미룬다. 그래서 샤드 핸들러 안에서 Get으로 받은 포인터는
+//   그 핸들러가 끝날 때까지 유효하다 (핸들러 밖으로 들고 나가려면 Lock).
+// - 반납된 슬롯은 FIFO로, 그리고 MIN_FREE_BEFORE_REUSE개가 쌓인 뒤에야 재사용한다.
+//   세대가 12비트뿐이라 방금 반납된 슬롯을 바로 다시 쓰면(LIFO) 접속/종료가 반복될 때
+//   4095번 만에 세대가 한 바퀴 돌아 오래된 핸들이 새 객체를 가리킬 수 있다.
+template <typename T>
+class SlotMap
+{
+public:
+    using Handle = std::uint32_t;
+    static constexpr Handle INVALID_HANDLE = 0;
+
+    static constexpr unsigned int INDEX_BITS = 20;
+    static constexpr std::uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr std::uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+    explicit SlotMap(IoContextPool& io_pool)
+        : io_pool_(io_pool)
+    {
+        for (auto& chunk : chunks_)
+            chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~SlotMap()
+    {
+        for (auto& chunk : chunks_)
+            delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    SlotMap(const SlotMap&) = delete;
+    SlotMap& operator=(const SlotMap&) = delete;
+
+    // 슬롯이 모두 찼으면 INVALID_HANDLE
+    Handle Insert(std::shared_ptr<T> object)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // 반납된 슬롯이 충분히 쌓였거나 새 슬롯이 바닥났을 때만 재사용 (가장 오래 쉰 것부터)
+        std::uint32_t index;
+        if (free_indices_.size() >= MIN_FREE_BEFORE_REUSE || (next_index_ > INDEX_MASK && !free_indices_.empty()))
+        {
+            index = free_indices_.front();
+            free_indices_.pop_front();
+        }
+        else
+        {
+            if (next_index_ > INDEX_MASK)
+                return INVALID_HANDLE;
+
+            index = next_index_++;
+            if ((index & CHUNK_MASK) == 0)
+                chunks_[index >> CHUNK_BITS].store(new Slot[CHUNK_LEN], std::memory_order_release);
+        }
+
+        Slot& slot = SlotAt(index);
+        slot.object.store(object.get(), std::memory_order_relaxed);
+        slot.owner = std::move(object);
+        ++size_;
+        return MakeHandle(slot.generation.load(std::memory_order_relaxed), index);
+    }
+
+    // 락 없음: 무효/해제된 핸들이면 nullptr
+    T* Get(Handle handle) const
+    {
+        const std::uint32_t index = handle & INDEX_MASK;
+        const Slot* chunk = chunks_[index >> CHUNK_BITS].load(std::memory_order_acquire);
+        if (!chunk)
+            return nullptr;
+
+        const Slot& slot = chunk[index & CHUNK_MASK];
+        if (slot.generation.load(std::memory_order_acquire) != (handle >> INDEX_BITS))
+            return nullptr;
+
+        return slot.object.load(std::memory_order_acquire);
+    }
+
+    // 핸들러 밖에서도 객체를 붙잡아야 할 때만 (락 + 참조 카운트)
+    std::shared_ptr<T> Lock(Handle handle) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!Get(handle))
+            return nullptr;
+        return SlotAt(handle & INDEX_MASK).owner;
+    }
+
+    void Remove(Handle handle)
+    {
+        std::shared_ptr<T> owner;
+        const std::uint32_t index = handle & INDEX_MASK;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!Get(handle))
+                return;
+
+            // 세대를 먼저 올려서 이후의 Get은 모두 실패 (0은 건너뜀)
+            Slot& slot = SlotAt(index);
+            std::uint32_t generation = (slot.generation.load(std::memory_order_relaxed) + 1) & GENERATION_MASK;
+            if (generation == 0)
+                generation = 1;
+            slot.generation.store(generation, std::memory_order_release);
+            slot.object.store(nullptr, std::memory_order_release);
+            owner = std::move(slot.owner);
+            --size_;
+        }
+
+        // 이미 Get으로 포인터를 받은 핸들러들이 끝난 뒤에 해제하고 슬롯 반납
+        io_pool_.PostAfterAllShards([this, index, owner = std::move(owner)]() mutable
+            {
+                owner.reset();
+                std::lock_guard<std::mutex> lock(mutex_);
+                free_indices_.push_back(index);
+            });
+    }
+
+    std::size_t Size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return size_;
+    }
+
+private:
+    static constexpr unsigned int CHUNK_BITS = 10;
+    static constexpr std::uint32_t CHUNK_LEN = 1u << CHUNK_BITS;
+    static constexpr std::uint32_t CHUNK_MASK = CHUNK_LEN - 1;
+    static constexpr std::size_t CHUNK_COUNT = std::size_t{ 1 } << (INDEX_BITS - CHUNK_BITS);
+
+    // 같은 슬롯이 다시 쓰이기까지 최소한 이만큼의 다른 반납이 필요 (세대가 한 바퀴 돌려면 그 4095배)
+    static constexpr std::size_t MIN_FREE_BEFORE_REUSE = 1024;
+
+    struct Slot
+    {
+        std::atomic<std::uint32_t> generation{ 1 };
+        std::atomic<T*> object{ nullptr };
+        std::shared_ptr<T> owner; // mutex_ 아래에서만 접근
+    };
+
+    static Handle MakeHandle(std::uint32_t generation, std::uint32_t index)
+    {
+        return (generation << INDEX_BITS) | index;
+    }
+
+    Slot& SlotAt(std::uint32_t index) const
+    {
+        return chunks_[index >> CHUNK_BITS].load(std::memory_order_relaxed)[index & CHUNK_MASK];
+    }
+
+    IoContextPool& io_pool_;
+
+    // 청크는 한 번 만들면 옮기지 않으므로 Get이 락 없이 읽을 수 있다
+    std::array<std::atomic<Slot*>, CHUNK_COUNT> chunks_;
+
+    std::deque<std::uint32_t> free_indices_; // 반납 순서대로
+    std::uint32_t next_index_ = 0;
+    std::size_t size_ = 0;
+    mutable std::mutex mutex_;
+};
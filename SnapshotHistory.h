@@ -0,0 +1,246 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Protocol.h"
+#include "BitPacking.h"
+
+// 한 틱의 방 플레이어 상태 (방 슬롯 인덱스 SoA, ids[slot] == 0이면 빈 슬롯)
+// - 방의 슬롯 배열을 count개만큼 그대로 복사해서 만든다 (정렬/포인터 추적 없음).
+struct PlayerSnapshot
+{
+    std::uint32_t seq = 0;
+    std::uint16_t count = 0; // 유효한 슬롯 범위 [0, count)
+    std::vector<std::uint32_t> ids;
+    std::vector<float> pos_x;
+    std::vector<float> pos_y;
+
+    void Resize(std::size_t capacity)
+    {
+        ids.assign(capacity, 0);
+        pos_x.assign(capacity, 0.0f);
+        pos_y.assign(capacity, 0.0f);
+        count = 0;
+        seq = 0;
+    }
+
+    void CopyFrom(const std::uint32_t* src_ids, const float* src_x, const float* src_y, std::uint16_t n)
+    {
+        std::memcpy(ids.data(), src_ids, n * sizeof(std::uint32_t));
+        std::memcpy(pos_x.data(), src_x, n * sizeof(float));
+        std::memcpy(pos_y.data(), src_y, n * sizeof(float));
+        count = n;
+    }
+
+    CharacterState StateAt(std::uint16_t slot) const { return CharacterState{ pos_x[slot], pos_y[slot] }; }
+};
+
+// 방별 최근 스냅샷 보관소 (방 strand에서만 접근)
+// - 클라이언트가 확인(ack)한 스냅샷이 아직 남아 있으면 그걸 기준으로 델타를 만든다.
+class SnapshotHistory
+{
+public:
+    static constexpr std::size_t HISTORY_LEN = 32; // 50ms 틱 기준 약 1.6초
+
+    // 방 정원만큼 미리 할당 (방 생성/재사용 시)
+    void Resize(std::size_t capacity)
+    {
+        for (auto& snapshot : snapshots_)
+            snapshot.Resize(capacity);
+        next_ = 0;
+    }
+
+    // 새 스냅샷 슬롯 (가장 오래된 것을 덮어씀)
+    PlayerSnapshot& Push(std::uint32_t seq)
+    {
+        next_ = (next_ + 1) % HISTORY_LEN;
+        PlayerSnapshot& snapshot = snapshots_[next_];
+        snapshot.seq = seq;
+        snapshot.count = 0;
+        return snapshot;
+    }
+
+    const PlayerSnapshot* Find(std::uint32_t seq) const
+    {
+        if (seq == 0)
+            return nullptr;
+
+        for (const auto& snapshot : snapshots_)
+        {
+            if (snapshot.seq == seq)
+                return &snapshot;
+        }
+        return nullptr;
+    }
+
+private:
+    std::array<PlayerSnapshot, HISTORY_LEN> snapshots_{};
+    std::size_t next_ = 0;
+};
+
+// baseline -> current 변경분 순회 (같은 슬롯끼리 비교, 슬롯 주인이 바뀌었으면 퇴장 + 입장)
+// fn(PLAYER_DELTA_FLAG, const PlayerSnapshot& source, std::uint16_t slot)
+// - LEFT는 baseline, 나머지는 current 쪽 슬롯을 넘긴다.
+template <typename Fn>
+void DiffSnapshots(const PlayerSnapshot& baseline, const PlayerSnapshot& current, Fn&& fn)
+{
+    const std::uint16_t count = std::max(baseline.count, current.count);
+    for (std::uint16_t slot = 0; slot < count; ++slot)
+    {
+        const std::uint32_t before = slot < baseline.count ? baseline.ids[slot] : 0;
+        const std::uint32_t after = slot < current.count ? current.ids[slot] : 0;
+
+        if (before == after)
+        {
+            if (after != 0 &&
+                (current.pos_x[slot] != baseline.pos_x[slot] || current.pos_y[slot] != baseline.pos_y[slot]))
+            {
+                fn(PLAYER_DELTA_CHANGED, current, slot);
+            }
+            continue;
+        }
+
+        if (before != 0)
+            fn(PLAYER_DELTA_LEFT, baseline, slot);
+        if (after != 0)
+            fn(PLAYER_DELTA_JOINED, current, slot);
+    }
+}
+
+// 지정한 슬롯들로 전체 스냅샷 패킷 한 개 작성 (count <= MAX_PLAYERS_PER_ROOM)
+// - 큰 방(AOI)은 유저마다 시야 안의 슬롯을 나눠서 여러 번 호출
+inline void BuildPlayerStatePart(const PlayerSnapshot& snapshot, const std::uint16_t* slots, std::uint16_t count,
+    std::uint8_t part_index, std::uint8_t part_count, PKT_NOTICE_PLAYER_STATE& pkt)
+{
+    pkt.pkt_id = NOTICE_PLAYER_STATE;
+
+    count = std::min(count, MAX_PLAYERS_PER_ROOM);
+    for (std::uint16_t i = 0; i < count; ++i)
+    {
+        pkt.players[i].userId = snapshot.ids[slots[i]];
+        pkt.players[i].state = snapshot.StateAt(slots[i]);
+    }
+
+    pkt.count = count;
+    WritePlayerStateInfo(pkt, { snapshot.seq, part_index, part_count });
+    pkt.pkt_size = NoticePlayerStateSize(count);
+}
+
+// 전체 스냅샷 패킷 작성 (작은 방: 패킷 한 개에 담기는 MAX_PLAYERS_PER_ROOM명까지)
+inline void BuildPlayerStateFull(const PlayerSnapshot& snapshot, PKT_NOTICE_PLAYER_STATE& pkt)
+{
+    std::uint16_t slots[MAX_PLAYERS_PER_ROOM];
+    std::uint16_t count = 0;
+    for (std::uint16_t slot = 0; slot < snapshot.count && count < MAX_PLAYERS_PER_ROOM; ++slot)
+    {
+        if (snapshot.ids[slot] != 0)
+            slots[count++] = slot;
+    }
+
+    BuildPlayerStatePart(snapshot, slots, count, 0, 1, pkt);
+}
+
+// baseline -> current 델타 패킷 작성
+inline void BuildPlayerStateDelta(const PlayerSnapshot& baseline, const PlayerSnapshot& current,
+    PKT_NOTICE_PLAYER_STATE_DELTA& pkt)
+{
+    pkt.pkt_id = NOTICE_PLAYER_STATE_DELTA;
+    pkt.snapshotSeq = current.seq;
+    pkt.baselineSeq = baseline.seq;
+
+    constexpr std::uint16_t capacity = sizeof(pkt.entries) / sizeof(pkt.entries[0]);
+    std::uint16_t count = 0;
+    DiffSnapshots(baseline, current,
+        [&pkt, &count](PLAYER_DELTA_FLAG flag, const PlayerSnapshot& source, std::uint16_t slot)
+        {
+            if (count >= capacity)
+                return;
+
+            auto& entry = pkt.entries[count++];
+            entry.userId = source.ids[slot];
+            entry.flag = flag;
+            entry.state = (flag == PLAYER_DELTA_LEFT) ? CharacterState{} : source.StateAt(slot);
+        });
+
+    pkt.count = count;
+    pkt.pkt_size = NoticePlayerStateDeltaSize(count);
+}
+
+// 압축 포맷 패킷 작성 (baseline이 없으면 전체, 있으면 바뀐 슬롯만)
+inline void BuildPlayerStateCompact(const PlayerSnapshot* baseline, const PlayerSnapshot& current,
+    const QuantizationParams& params, PKT_NOTICE_PLAYER_STATE_COMPACT& pkt)
+{
+    pkt.pkt_id = NOTICE_PLAYER_STATE_COMPACT;
+    pkt.snapshotSeq = current.seq;
+    pkt.baselineSeq = baseline ? baseline->seq : 0;
+    pkt.partIndex = 0;
+    pkt.partCount = 1;
+    std::memset(pkt.data, 0, sizeof(pkt.data));
+
+    BitWriter writer(pkt.data, sizeof(pkt.data));
+    const unsigned int entry_bits = params.slot_bits + params.position_bits * 2u;
+    std::uint8_t count = 0;
+    auto write = [&writer, &count, &params, entry_bits](const PlayerSnapshot& source, std::uint16_t slot)
+        {
+            // 항목이 잘리지 않도록 통째로 들어갈 때만
+            if (count >= MAX_PLAYERS_PER_ROOM || writer.BitsRemaining() < entry_bits)
+                return;
+
+            writer.Write(slot, params.slot_bits);
+            writer.Write(QuantizeCoord(source.pos_x[slot], params.min_x, params.max_x, params.position_bits), params.position_bits);
+            writer.Write(QuantizeCoord(source.pos_y[slot], params.min_y, params.max_y, params.position_bits), params.position_bits);
+            ++count;
+        };
+
+    if (baseline)
+    {
+        DiffSnapshots(*baseline, current,
+            [&write](PLAYER_DELTA_FLAG flag, const PlayerSnapshot& source, std::uint16_t slot)
+            {
+                if (flag != PLAYER_DELTA_LEFT)
+                    write(source, slot);
+            });
+    }
+    else
+    {
+        for (std::uint16_t slot = 0; slot < current.count; ++slot)
+        {
+            if (current.ids[slot] != 0)
+                write(current, slot);
+        }
+    }
+
+    pkt.count = count;
+    pkt.pkt_size = NoticePlayerStateCompactSize(writer.BytesWritten());
+}
+
+// 지정한 슬롯들로 압축 포맷 전체 스냅샷 패킷 한 개 작성 (AOI 분할 전송, count <= MAX_PLAYERS_PER_ROOM)
+inline void BuildPlayerStateCompactPart(const PlayerSnapshot& snapshot, const std::uint16_t* slots, std::uint16_t count,
+    const QuantizationParams& params, std::uint8_t part_index, std::uint8_t part_count,
+    PKT_NOTICE_PLAYER_STATE_COMPACT& pkt)
+{
+    pkt.pkt_id = NOTICE_PLAYER_STATE_COMPACT;
+    pkt.snapshotSeq = snapshot.seq;
+    pkt.baselineSeq = 0;
+    pkt.partIndex = part_index;
+    pkt.partCount = part_count;
+    std::memset(pkt.data, 0, sizeof(pkt.data));
+
+    // 항목당 최대 48비트 x MAX_PLAYERS_PER_ROOM = data 크기이므로 항상 들어간다
+    BitWriter writer(pkt.data, sizeof(pkt.data));
+    count = std::min(count, MAX_PLAYERS_PER_ROOM);
+    for (std::uint16_t i = 0; i < count; ++i)
+    {
+        const std::uint16_t slot = slots[i];
+        writer.Write(slot, params.slot_bits);
+        writer.Write(QuantizeCoord(snapshot.pos_x[slot], params.min_x, params.max_x, params.position_bits), params.position_bits);
+        writer.Write(QuantizeCoord(snapshot.pos_y[slot], params.min_y, params.max_y, params.position_bits), params.position_bits);
+    }
+
+    pkt.count = static_cast<std::uint8_t>(count);
+    pkt.pkt_size = NoticePlayerStateCompactSize(writer.BytesWritten());
+}
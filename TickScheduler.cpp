@@ -0,0 +1,148 @@
+﻿#include "TickScheduler.h"
+#include "Room.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+using Clock = std::chrono::steady_clock;
+
+TickScheduler::TickScheduler(IoContextPool& io_pool, const RoomTickConfig& config)
+    : io_pool_(io_pool)
+    , config_(config)
+    , slot_interval_(std::max<Clock::duration>(config.base_interval / PHASE_COUNT, std::chrono::milliseconds(1)))
+{
+    for (std::size_t i = 0; i < io_pool_.Size(); ++i)
+    {
+        shards_.push_back(std::make_unique<Shard>(i, io_pool_.GetIoContext(i)));
+    }
+}
+
+void TickScheduler::Start()
+{
+    const auto now = Clock::now();
+    for (auto& shard : shards_)
+    {
+        Shard* target = shard.get();
+        boost::asio::post(shard->io_context, [this, target, now]()
+            {
+                target->slot_time = now;
+                ScheduleSlot(*target);
+            });
+    }
+}
+
+void TickScheduler::Stop()
+{
+    stopped_ = true;
+    for (auto& shard : shards_)
+    {
+        Shard* target = shard.get();
+        boost::asio::post(shard->io_context, [target]()
+            {
+                target->timer.cancel();
+            });
+    }
+}
+
+void TickScheduler::Register(std::shared_ptr<Room> room, std::size_t shard_index)
+{
+    Shard* target = shards_[shard_index % shards_.size()].get();
+    boost::asio::post(target->io_context, [target, room = std::move(room)]() mutable
+        {
+            // 방이 가장 적은 phase에 배치해서 슬롯별 부하를 고르게
+            auto least = std::min_element(target->phases.begin(), target->phases.end(),
+                [](const auto& lhs, const auto& rhs) { return lhs.size() < rhs.size(); });
+            least->push_back(std::move(room));
+        });
+}
+
+void TickScheduler::Unregister(std::shared_ptr<Room> room, std::size_t shard_index)
+{
+    // 같은 샤드로 post하므로 앞서 보낸 Register보다 먼저 실행되지 않는다
+    Shard* target = shards_[shard_index % shards_.size()].get();
+    boost::asio::post(target->io_context, [target, room = std::move(room)]()
+        {
+            for (auto& phase : target->phases)
+            {
+                auto it = std::find(phase.begin(), phase.end(), room);
+                if (it != phase.end())
+                {
+                    phase.erase(it);
+                    return;
+                }
+            }
+        });
+}
+
+void TickScheduler::ScheduleSlot(Shard& shard)
+{
+    if (stopped_)
+        return;
+
+    shard.slot_time += slot_interval_;
+    shard.timer.expires_at(shard.slot_time);
+    shard.timer.async_wait(MakeAllocatingHandler(shard.timer_handler_memory,
+        [this, &shard](const boost::system::error_code& ec)
+        {
+            if (ec)
+                return;
+
+            OnSlot(shard);
+            ScheduleSlot(shard);
+        }));
+}
+
+void TickScheduler::OnSlot(Shard& shard)
+{
+    const auto now = Clock::now();
+    const auto lateness = now - shard.slot_time;
+
+    auto& rooms = shard.phases[shard.current_phase];
+    shard.current_phase = (shard.current_phase + 1) % PHASE_COUNT;
+
+    ++stats_.slots;
+    if (lateness > config_.late_threshold)
+    {
+        ReportLateSlot(shard, lateness, rooms.size());
+    }
+
+    // 이 phase의 방들을 한 번에 처리 (방이 스스로 주기가 됐는지 판단)
+    // - 방 내부 상태는 방 strand에서만 만지므로 strand로 넘긴다 (같은 샤드라 대부분 바로 이어서 실행)
+    const auto slot_time = shard.slot_time;
+    for (auto& room : rooms)
+    {
+        boost::asio::dispatch(room->GetStrand(), [room, slot_time, lateness]()
+            {
+                room->OnSchedulerTick(slot_time, lateness);
+            });
+    }
+
+    // 너무 밀렸으면 쫓아가지 말고 현재 시각부터 다시
+    if (now - shard.slot_time > config_.base_interval)
+    {
+        shard.slot_time = now;
+    }
+}
+
+void TickScheduler::ReportLateSlot(Shard& shard, Clock::duration lateness, std::size_t room_count)
+{
+    ++stats_.late_slots;
+
+    const auto lateness_us = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(lateness).count());
+    std::uint64_t prev = stats_.max_lateness_us.load(std::memory_order_relaxed);
+    while (lateness_us > prev &&
+        !stats_.max_lateness_us.compare_exchange_weak(prev, lateness_us, std::memory_order_relaxed))
+    {
+    }
+
+    // 로그는 샤드당 초당 1회까지만
+    const auto now = Clock::now();
+    if (now - shard.last_late_report < std::chrono::seconds(1))
+        return;
+
+    shard.last_late_report = now;
+    LOG_WARN("Late tick on shard %zu: %.3fms behind (rooms in phase: %zu, late slots: %llu)",
+        shard.index, lateness_us / 1000.0, room_count,
+        static_cast<unsigned long long>(stats_.late_slots.load()));
+}
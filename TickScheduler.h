@@ -0,0 +1,85 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "IoContextPool.h"
+#include "ServerConfig.h"
+#include "HandlerAllocator.h"
+#include "Logger.h"
+
+class Room;
+
+// 모든 방의 틱을 관리하는 스케줄러
+// - 샤드(io_context)마다 타이머 하나만 두고, 기본 틱 주기를 PHASE_COUNT개의 슬롯으로 나눈다.
+// - 방은 자기 샤드에서 가장 한가한 phase에 배치되고, 슬롯이 돌아오면 그 phase의 방들을 한 번에 처리한다.
+// - 방마다 타이머를 두던 때처럼 모든 방이 같은 순간에 깨어나는 50ms 버스트가 생기지 않는다.
+class TickScheduler
+{
+public:
+    static constexpr std::size_t PHASE_COUNT = 10;
+
+    struct Stats
+    {
+        std::atomic<std::uint64_t> slots{ 0 };           // 처리한 슬롯 수
+        std::atomic<std::uint64_t> late_slots{ 0 };      // late_threshold 이상 늦은 슬롯 수
+        std::atomic<std::uint64_t> max_lateness_us{ 0 }; // 가장 많이 늦은 값
+
+        void Report() const
+        {
+            LOG_INFO("TickScheduler stats - slots: %llu, late slots: %llu, max lateness: %.3fms",
+                static_cast<unsigned long long>(slots.load()),
+                static_cast<unsigned long long>(late_slots.load()),
+                max_lateness_us.load() / 1000.0);
+        }
+    };
+
+    TickScheduler(IoContextPool& io_pool, const RoomTickConfig& config);
+
+    TickScheduler(const TickScheduler&) = delete;
+    TickScheduler& operator=(const TickScheduler&) = delete;
+
+    void Start();
+    void Stop();
+
+    // 방을 shard_index 샤드의 가장 한가한 phase에 등록 (아무 쓰레드에서나 호출 가능)
+    // - 빈 방은 등록하지 않는다: 첫 입장 때 Register, 마지막 퇴장 때 Unregister (Room이 호출)
+    void Register(std::shared_ptr<Room> room, std::size_t shard_index);
+    void Unregister(std::shared_ptr<Room> room, std::size_t shard_index);
+
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    struct Shard
+    {
+        Shard(std::size_t index, boost::asio::io_context& io_context)
+            : index(index), io_context(io_context), timer(io_context), phases(PHASE_COUNT)
+        {
+        }
+
+        std::size_t index;
+        boost::asio::io_context& io_context;
+        boost::asio::steady_timer timer;
+        std::vector<std::vector<std::shared_ptr<Room>>> phases;
+        std::size_t current_phase = 0;
+        std::chrono::steady_clock::time_point slot_time{};
+        std::chrono::steady_clock::time_point last_late_report{};
+        HandlerMemory timer_handler_memory; // 슬롯 타이머 대기는 한 번에 하나 (매 슬롯 재사용)
+    };
+
+    void ScheduleSlot(Shard& shard);
+    void OnSlot(Shard& shard);
+    void ReportLateSlot(Shard& shard, std::chrono::steady_clock::duration lateness, std::size_t room_count);
+
+    IoContextPool& io_pool_;
+    RoomTickConfig config_;
+    std::chrono::steady_clock::duration slot_interval_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> stopped_{ false };
+    Stats stats_;
+};
@@ -0,0 +1,206 @@
+﻿#include "UdpChannel.h"
+#include "PacketHandler.h"
+
+#include <cstring>
+#include <random>
+
+using boost::asio::awaitable;
+using boost::asio::redirect_error;
+using boost::asio::use_awaitable;
+using boost::system::error_code;
+
+namespace
+{
+    // 앞서 발급한 값들로 다음 값을 알아낼 수 없도록 의사 난수 엔진이 아닌 OS 난수(CSPRNG)에서 직접 뽑는다
+    std::uint64_t RandomSecret()
+    {
+        thread_local std::random_device device;
+        std::uint64_t secret;
+        do
+        {
+            secret = (static_cast<std::uint64_t>(device()) << 32) | device();
+        } while (secret == 0);
+        return secret;
+    }
+}
+
+UdpChannel::UdpChannel(boost::asio::io_context& io_context, std::uint16_t port,
+    const SlotMap<Session>& sessions, PacketDispatcher& dispatcher)
+    : socket_(io_context, udp::endpoint(udp::v4(), port))
+    , port_(port)
+    , sessions_(sessions)
+    , dispatcher_(dispatcher)
+{
+    // 송신은 동기 send_to: 소켓 버퍼가 차면 기다리지 않고 그 스냅샷은 버린다
+    socket_.non_blocking(true);
+}
+
+UdpChannel::~UdpChannel()
+{
+    while (SendNode* node = send_queue_.Pop())
+        ReleaseSendNode(node);
+}
+
+void UdpChannel::Start()
+{
+    boost::asio::co_spawn(socket_.get_executor(), ReceiveLoop(), boost::asio::detached);
+}
+
+void UdpChannel::Close()
+{
+    boost::asio::post(socket_.get_executor(), [this]()
+        {
+            error_code ec;
+            socket_.close(ec);
+        });
+}
+
+UDP_TOKEN UdpChannel::IssueToken(Session& session)
+{
+    const std::uint64_t secret = RandomSecret();
+    session.SetUdpSecret(secret);
+    return UDP_TOKEN{ session.GetHandle(), secret };
+}
+
+awaitable<void> UdpChannel::ReceiveLoop()
+{
+    error_code ec;
+    while (socket_.is_open())
+    {
+        const std::size_t size = co_await socket_.async_receive_from(boost::asio::buffer(recv_buffer_), sender_,
+            WithHandlerMemory(receive_memory_, redirect_error(use_awaitable, ec)));
+
+        if (ec == boost::asio::error::operation_aborted)
+            co_return;
+
+        // ICMP port unreachable 등은 그 데이터그램 하나의 문제이므로 계속 받는다
+        if (!ec)
+            HandleDatagram(size);
+    }
+}
+
+void UdpChannel::HandleDatagram(std::size_t size)
+{
+    if (size < sizeof(UDP_HEADER) + sizeof(PACKET_HEADER))
+    {
+        ++stats_.rejected;
+        return;
+    }
+
+    UDP_HEADER udp_header;
+    std::memcpy(&udp_header, recv_buffer_.data(), sizeof(udp_header));
+
+    const char* data = recv_buffer_.data() + sizeof(UDP_HEADER);
+    const std::size_t packet_size = size - sizeof(UDP_HEADER);
+    const auto& header = *reinterpret_cast<const PACKET_HEADER*>(data);
+
+    // 상태/확인 패킷만 UDP로 받는다 (로그인/채팅 등은 TCP 전용)
+    if (header.pkt_size != packet_size ||
+        (header.pkt_id != REQ_PLAYER_STATE && header.pkt_id != REQ_SNAPSHOT_ACK))
+    {
+        ++stats_.rejected;
+        return;
+    }
+
+    const std::uint64_t secret = udp_header.token.secret;
+    Session* session = sessions_.Get(udp_header.token.session);
+    if (!session || secret == 0 || session->GetUdpSecret() != secret || !session->IsAuthenticated())
+    {
+        ++stats_.bad_token;
+        return;
+    }
+
+    // 재로그인으로 비밀값이 바뀌었으면 sequence부터 새로 시작
+    UdpPeerState& peer = session->GetUdpPeer();
+    if (peer.secret != secret)
+        peer = UdpPeerState{ {}, secret, 0, 0 };
+
+    if (!IsNewerSequence(udp_header.sequence, peer.last_recv_seq))
+    {
+        ++stats_.stale_dropped;
+        return;
+    }
+
+    peer.last_recv_seq = udp_header.sequence;
+    peer.endpoint = sender_; // NAT 재바인딩이 있어도 가장 최근 주소로 보낸다
+    session->SetUdpBound(true);
+    ++stats_.received;
+
+    dispatcher_.DispatchPacket(*session, header, data, packet_size);
+}
+
+void UdpChannel::Send(SessionHandle target, SendBufferPtr packet)
+{
+    SendNode* node = AcquireSendNode();
+    node->packet = std::move(packet);
+    node->target = target;
+    send_queue_.Push(node);
+
+    // 적재를 먼저 공개한 뒤 플래그 확인 (ReleaseFlushFlag의 반대 순서와 짝)
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!flush_scheduled_.exchange(true, std::memory_order_acq_rel))
+    {
+        boost::asio::post(socket_.get_executor(), MakeAllocatingHandler(flush_memory_, [this]()
+            {
+                Flush();
+            }));
+    }
+}
+
+void UdpChannel::Flush()
+{
+    while (SendNode* node = send_queue_.Pop())
+    {
+        SendTo(*node);
+        ReleaseSendNode(node);
+    }
+
+    if (ReleaseFlushFlag())
+    {
+        // Push 도중인 노드면 곧 연결되므로 핸들러를 한 번 양보하고 다시 시도
+        boost::asio::post(socket_.get_executor(), MakeAllocatingHandler(flush_memory_, [this]()
+            {
+                Flush();
+            }));
+    }
+}
+
+void UdpChannel::SendTo(const SendNode& node)
+{
+    // 그 사이 끊겼거나 로그아웃/재로그인했으면 버림
+    Session* session = sessions_.Get(node.target);
+    if (!session || !session->IsUdpBound())
+        return;
+
+    UdpPeerState& peer = session->GetUdpPeer();
+    if (peer.secret == 0 || session->GetUdpSecret() != peer.secret)
+        return;
+
+    UDP_HEADER udp_header;
+    udp_header.token = UDP_TOKEN{ node.target, peer.secret };
+    udp_header.sequence = ++peer.next_send_seq;
+
+    const std::array<boost::asio::const_buffer, 2> buffers = {
+        boost::asio::buffer(&udp_header, sizeof(udp_header)),
+        node.packet->AsBuffer(),
+    };
+
+    error_code ec;
+    socket_.send_to(buffers, peer.endpoint, 0, ec);
+    if (ec)
+        ++stats_.send_failed;
+    else
+        ++stats_.sent;
+}
+
+bool UdpChannel::ReleaseFlushFlag()
+{
+    flush_scheduled_.store(false, std::memory_order_release);
+
+    // Send는 적재 -> 플래그 순, 여기는 플래그 -> 큐 확인 순: 둘 중 하나는 반드시 상대를 본다
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (send_queue_.Empty())
+        return false;
+
+    return !flush_scheduled_.exchange(true, std::memory_order_acq_rel);
+}
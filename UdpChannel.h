@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include <boost/asio.hpp>
+
+#include "Protocol.h"
+#include "SendBuffer.h"
+#include "SendQueue.h"
+#include "HandlerAllocator.h"
+#include "SlotMap.h"
+#include "Session.h"
+#include "Logger.h"
+
+class PacketDispatcher;
+
+struct UdpChannelStats
+{
+    std::atomic<std::uint64_t> received{ 0 };      // 처리한 데이터그램
+    std::atomic<std::uint64_t> stale_dropped{ 0 }; // 순서가 뒤바뀌었거나 중복이라 버림
+    std::atomic<std::uint64_t> rejected{ 0 };      // 크기/패킷 종류가 맞지 않음
+    std::atomic<std::uint64_t> bad_token{ 0 };     // 끊긴 세션이나 재로그인 전의 토큰, 또는 틀린 토큰
+    std::atomic<std::uint64_t> sent{ 0 };
+    std::atomic<std::uint64_t> send_failed{ 0 };   // 소켓 버퍼가 가득 차는 등 (UDP라 재시도하지 않음)
+
+    void Report() const
+    {
+        LOG_INFO("UDP channel stats - received: %llu, stale dropped: %llu, rejected: %llu, bad token: %llu, sent: %llu, send failed: %llu",
+            static_cast<unsigned long long>(received.load()),
+            static_cast<unsigned long long>(stale_dropped.load()),
+            static_cast<unsigned long long>(rejected.load()),
+            static_cast<unsigned long long>(bad_token.load()),
+            static_cast<unsigned long long>(sent.load()),
+            static_cast<unsigned long long>(send_failed.load()));
+    }
+};
+
+// ===== 상태 전용 UDP 채널 =====
+// - TCP 한 줄기에 상태 스냅샷이 섞이면 세그먼트 하나만 유실돼도 뒤의 새 스냅샷이 전부 막힌다.
+//   상태만 UDP로 빼서, 유실된 것은 다음 틱이 대체하고 늦게 온 것은 sequence로 버린다.
+// - 소켓 하나를 I/O 샤드 하나가 전담한다: 수신, 세션별 UDP 상태(주소/sequence), 실제 송신 모두 그 샤드에서만.
+// - 다른 쓰레드(방 틱)는 Send로 락 없는 큐에 넣고, 처음 넣은 쪽만 샤드에 flush를 post한다.
+// - 토큰 비밀값은 64비트 OS 난수라 추측할 수 없으므로, 토큰이 안 맞는 데이터그램은 주소와 상관없이 세고 버리기만 한다.
+//   (IP 단위로 막으면 같은 NAT 뒤의 정상 유저나, 주소를 위조당한 쪽이 대신 막힌다)
+class UdpChannel
+{
+public:
+    using udp = boost::asio::ip::udp;
+
+    UdpChannel(boost::asio::io_context& io_context, std::uint16_t port,
+        const SlotMap<Session>& sessions, PacketDispatcher& dispatcher);
+    ~UdpChannel();
+
+    UdpChannel(const UdpChannel&) = delete;
+    UdpChannel& operator=(const UdpChannel&) = delete;
+
+    void Start();
+    void Close();
+
+    // 로그인 시 (세션 샤드): 세션에 새 비밀값을 주고 클라이언트에게 줄 토큰 반환
+    UDP_TOKEN IssueToken(Session& session);
+
+    // 아무 쓰레드: 채널이 연결된 세션의 상태 스냅샷 전송
+    void Send(SessionHandle target, SendBufferPtr packet);
+
+    std::uint16_t GetPort() const { return port_; }
+    const UdpChannelStats& GetStats() const { return stats_; }
+
+private:
+    boost::asio::awaitable<void> ReceiveLoop();
+    void HandleDatagram(std::size_t size);
+
+    void Flush();
+    void SendTo(const SendNode& node);
+
+    // 큐가 비었으면 flush 플래그를 내림. 그 사이 새로 들어와서 다시 가져왔으면 true
+    bool ReleaseFlushFlag();
+
+    udp::socket socket_;
+    std::uint16_t port_;
+    const SlotMap<Session>& sessions_;
+    PacketDispatcher& dispatcher_;
+    UdpChannelStats stats_;
+
+    // 수신 (채널 샤드 전용)
+    std::array<char, sizeof(UDP_HEADER) + MAX_RECEIVE_BUFFER_LEN> recv_buffer_;
+    udp::endpoint sender_;
+    HandlerMemory receive_memory_;
+
+    // 송신 큐 (생산자 여럿, 소비자는 채널 샤드)
+    SendQueue send_queue_;
+    std::atomic<bool> flush_scheduled_{ false }; // true로 바꾼 쪽이 flush를 post
+    HandlerMemory flush_memory_;
+};
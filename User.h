@@ -1,35 +1,90 @@
 ﻿#pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <mutex>
+#include <vector>
+#include <utility>
 #include<memory>
 
 #include "Session.h"
 
+class Room;
+
 class User
 {
 public:
     User(uint32_t id, const std::string& username)
-        : id_(id), username_(username), is_online_(false)
+        : id_(id), username_(username)
     {
     }
 
     uint32_t GetId() const { return id_; }
+
+    // UserManager가 등록할 때 받은 SlotMap 핸들
+    UserHandle GetHandle() const { return handle_; }
+    void SetHandle(UserHandle handle) { handle_ = handle; }
     const std::string& GetUsername() const { return username_; }
-    bool IsOnline() const { return is_online_; }
-    void SetOnline(bool online) { is_online_ = online; }
+    // 세션 샤드에서 쓰고 방 strand에서 읽음
+    bool IsOnline() const { return is_online_.load(std::memory_order_relaxed); }
+    void SetOnline(bool online) { is_online_.store(online, std::memory_order_relaxed); }
 
-    void SetSession(std::shared_ptr<Session> session) { session_ = session; }
-    std::weak_ptr<Session> GetSession() const { return session_; }
+    // 로그인한 세션 (SlotMap<Session> 핸들, 로그아웃/끊김 시 INVALID_HANDLE로 되돌림)
+    void SetSessionHandle(SessionHandle handle) { session_handle_.store(handle, std::memory_order_relaxed); }
+    SessionHandle GetSessionHandle() const { return session_handle_.load(std::memory_order_relaxed); }
     
-    const CharacterState& GetCharacterState() const { return character_state_; }
-    void SetCharacterState(const CharacterState& state) { character_state_ = state; }
-    void ResetCharacterState() { character_state_ = CharacterState{}; }
+    // 입장해 있는 방 목록 (Room::AddUser/RemoveUser에서 갱신)
+    void JoinRoom(uint32_t room_id, const std::shared_ptr<Room>& room)
+    {
+        std::lock_guard<std::mutex> lock(rooms_mutex_);
+        rooms_.emplace_back(room_id, room);
+    }
+
+    void LeaveRoom(uint32_t room_id)
+    {
+        std::lock_guard<std::mutex> lock(rooms_mutex_);
+        for (auto it = rooms_.begin(); it != rooms_.end(); ++it)
+        {
+            if (it->first == room_id)
+            {
+                rooms_.erase(it);
+                return;
+            }
+        }
+    }
+
+    // 복사 없이 입장한 방들에 대해 fn(Room&) 호출
+    template <typename Fn>
+    void ForEachRoom(Fn&& fn) const
+    {
+        std::lock_guard<std::mutex> lock(rooms_mutex_);
+        for (const auto& pair : rooms_)
+        {
+            if (auto room = pair.second.lock())
+                fn(*room);
+        }
+    }
+
+    // 마지막으로 입장한 방 (방 채팅 채널), 없으면 nullptr
+    std::shared_ptr<Room> GetCurrentRoom() const
+    {
+        std::lock_guard<std::mutex> lock(rooms_mutex_);
+        for (auto it = rooms_.rbegin(); it != rooms_.rend(); ++it)
+        {
+            if (auto room = it->second.lock())
+                return room;
+        }
+        return nullptr;
+    }
 
 private:
     uint32_t id_;
+    UserHandle handle_ = 0;
     std::string username_;
-    bool is_online_;
-    std::weak_ptr<Session> session_;
-    CharacterState character_state_{};
+    std::atomic<bool> is_online_{ false };
+    std::atomic<SessionHandle> session_handle_{ 0 };
+
+    std::vector<std::pair<uint32_t, std::weak_ptr<Room>>> rooms_;
+    mutable std::mutex rooms_mutex_;
 };
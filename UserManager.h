@@ -1,95 +1,91 @@
 ﻿#pragma once
 
 #include <atomic>
-#include <mutex>
 #include <memory>
-#include <unordered_map>
+#include <string>
 #include <vector>
-#include <iostream>
 
 #include "User.h"
+#include "ShardedMap.h"
+#include "SlotMap.h"
+#include "IoContextPool.h"
+#include "Logger.h"
 
 class UserManager
 {
 public:
-    UserManager() : next_user_id_(1) {}
+    explicit UserManager(IoContextPool& io_pool)
+        : handles_(io_pool)
+        , next_user_id_(1)
+    {
+    }
 
     std::shared_ptr<User> CreateUser(const std::string& username)
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
-
-        // 중복 사용자명 확인
-        for (const auto& pair : users_)
-        {
-            if (pair.second->GetUsername() == username)
-                return nullptr; // 이미 존재하는 사용자명
-        }
-
         uint32_t user_id = next_user_id_++;
         auto user = std::make_shared<User>(user_id, username);
-        users_[user_id] = user;
 
-        std::cout << "User created: " << username
-            << " (ID: " << user_id << ")" << std::endl;
+        // 이름 인덱스에 먼저 등록 (중복 확인과 예약을 한 번에)
+        if (!users_by_name_.TryInsert(username, user))
+            return nullptr; // 이미 존재하는 사용자명
+
+        user->SetHandle(handles_.Insert(user));
+        users_.InsertOrAssign(user_id, user);
+
+        LOG_INFO("User created: %s (ID: %u)", username.c_str(), user_id);
         return user;
     }
 
     std::shared_ptr<User> GetUser(uint32_t user_id)
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
-        auto it = users_.find(user_id);
-        return (it != users_.end()) ? it->second : nullptr;
+        return users_.Find(user_id);
+    }
+
+    // 패킷 처리 중 핸들로 조회 (락/참조 카운트 없음, 포인터는 현재 핸들러 안에서만 유효)
+    User* Resolve(UserHandle handle) const
+    {
+        return handles_.Get(handle);
     }
 
     std::shared_ptr<User> GetUserByName(const std::string& username)
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
-        for (const auto& pair : users_)
-        {
-            if (pair.second->GetUsername() == username)
-                return pair.second;
-        }
-        return nullptr;
+        return users_by_name_.Find(username);
     }
 
     bool RemoveUser(uint32_t user_id)
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
-        auto it = users_.find(user_id);
-        if (it != users_.end())
-        {
-            std::cout << "User removed: " << it->second->GetUsername()
-                << " (ID: " << user_id << ")" << std::endl;
-            users_.erase(it);
-            return true;
-        }
-        return false;
+        auto user = users_.Extract(user_id);
+        if (!user)
+            return false;
+
+        users_by_name_.EraseIf(user->GetUsername(),
+            [&user](const std::shared_ptr<User>& indexed) { return indexed == user; });
+        handles_.Remove(user->GetHandle());
+
+        LOG_INFO("User removed: %s (ID: %u)", user->GetUsername().c_str(), user_id);
+        return true;
     }
 
     std::vector<std::shared_ptr<User>> GetOnlineUsers()
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
         std::vector<std::shared_ptr<User>> online_users;
-
-        for (const auto& pair : users_)
-        {
-            if (pair.second->IsOnline())
+        users_.ForEach([&online_users](uint32_t, const std::shared_ptr<User>& user)
             {
-                online_users.push_back(pair.second);
-            }
-        }
+                if (user->IsOnline())
+                    online_users.push_back(user);
+            });
 
         return online_users;
     }
 
     size_t GetUserCount() const
     {
-        std::lock_guard<std::mutex> lock(users_mutex_);
-        return users_.size();
+        return users_.Size();
     }
 
 private:
-    std::unordered_map<uint32_t, std::shared_ptr<User>> users_;
-    mutable std::mutex users_mutex_;
-    std::atomic<uint32_t> next_user_id_;
+    ShardedMap<uint32_t, std::shared_ptr<User>> users_;
+    ShardedMap<std::string, std::shared_ptr<User>> users_by_name_; // username -> user
+    SlotMap<User> handles_; // UserHandle -> user
+    std::atomic<uint32_t> next_user_id_; // 다음에 발급할 유저 ID (재사용하지 않음)
 };
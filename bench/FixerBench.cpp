@@ -0,0 +1,357 @@
+﻿#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "Protocol.h"
+
+// ===== FixerServer 부하 벤치마크 클라이언트 =====
+// - 세션 N개로 로그인한 뒤, 세션마다 일정 주기로 자기 자신에게 귓속말을 보내 왕복 지연을 잰다.
+// - 출력: READY / MEASURE_BEGIN / RESULT / HOLD_BEGIN 줄 (compare.sh가 이 줄로 구간을 맞춘다)
+//
+// 사용법: FixerBench [--host H] [--port N] [--sessions N] [--threads N]
+//                    [--ping-hz F] [--connect-rate F]
+//                    [--warmup-sec N] [--duration-sec N] [--hold-sec N]
+
+namespace asio = boost::asio;
+using asio::ip::tcp;
+using boost::system::error_code;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct BenchConfig
+    {
+        std::string host = "127.0.0.1";
+        std::uint16_t port = PORT_NUMBER;
+        std::size_t sessions = 10000;
+        std::size_t threads = 4;
+        double ping_hz = 1.0;         // 세션당 초당 핑
+        double connect_rate = 2000.0; // 초당 새 연결 수 (accept 백로그가 넘치지 않도록)
+        unsigned int warmup_sec = 5;
+        unsigned int duration_sec = 30;
+        unsigned int hold_sec = 0;    // 결과 출력 뒤 부하를 유지하는 시간 (syscall 측정용)
+
+        static BenchConfig FromArgs(int argc, char* argv[])
+        {
+            BenchConfig config;
+            for (int i = 1; i < argc; ++i)
+            {
+                const bool has_value = i + 1 < argc;
+                if (std::strcmp(argv[i], "--host") == 0 && has_value)
+                    config.host = argv[++i];
+                else if (std::strcmp(argv[i], "--port") == 0 && has_value)
+                    config.port = static_cast<std::uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+                else if (std::strcmp(argv[i], "--sessions") == 0 && has_value)
+                    config.sessions = std::strtoul(argv[++i], nullptr, 10);
+                else if (std::strcmp(argv[i], "--threads") == 0 && has_value)
+                    config.threads = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+                else if (std::strcmp(argv[i], "--ping-hz") == 0 && has_value)
+                    config.ping_hz = std::max(0.01, std::strtod(argv[++i], nullptr));
+                else if (std::strcmp(argv[i], "--connect-rate") == 0 && has_value)
+                    config.connect_rate = std::max(1.0, std::strtod(argv[++i], nullptr));
+                else if (std::strcmp(argv[i], "--warmup-sec") == 0 && has_value)
+                    config.warmup_sec = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+                else if (std::strcmp(argv[i], "--duration-sec") == 0 && has_value)
+                    config.duration_sec = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+                else if (std::strcmp(argv[i], "--hold-sec") == 0 && has_value)
+                    config.hold_sec = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+                else
+                    std::fprintf(stderr, "Unknown option ignored: %s\n", argv[i]);
+            }
+            return config;
+        }
+    };
+
+    // 쓰레드(io_context)마다 하나, 그 쓰레드에서만 갱신
+    struct ThreadStats
+    {
+        std::vector<std::uint32_t> latencies_us;
+        std::uint64_t pings_sent = 0;
+        std::uint64_t skipped = 0; // 이전 핑 응답이 아직 안 와서 건너뜀
+    };
+
+    std::atomic<bool> g_measuring{ false };
+    std::atomic<std::size_t> g_logged_in{ 0 };
+    std::atomic<std::size_t> g_failed{ 0 };
+
+    std::int64_t NowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    class BenchClient : public std::enable_shared_from_this<BenchClient>
+    {
+    public:
+        BenchClient(asio::io_context& io_context, ThreadStats& stats, const BenchConfig& config, std::size_t index)
+            : socket_(io_context)
+            , ping_timer_(io_context)
+            , stats_(stats)
+            , config_(config)
+            , name_("bench" + std::to_string(index))
+            , index_(index)
+        {
+            recv_buffer_.resize(SESSION_RECV_BUFFER_LEN);
+        }
+
+        void Start(const tcp::endpoint& endpoint, Clock::duration delay)
+        {
+            asio::co_spawn(socket_.get_executor(), Run(shared_from_this(), endpoint, delay), asio::detached);
+        }
+
+    private:
+        asio::awaitable<void> Run(std::shared_ptr<BenchClient> self, tcp::endpoint endpoint, Clock::duration delay)
+        {
+            error_code ec;
+            ping_timer_.expires_after(delay);
+            co_await ping_timer_.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+
+            co_await socket_.async_connect(endpoint, asio::redirect_error(asio::use_awaitable, ec));
+            if (ec)
+            {
+                ++g_failed;
+                co_return;
+            }
+            socket_.set_option(tcp::no_delay(true), ec);
+
+            PKT_REQ_LOGIN login{};
+            login.pkt_id = REQ_LOGIN;
+            login.pkt_size = sizeof(login);
+            std::snprintf(login.userId, sizeof(login.userId), "%s", name_.c_str());
+            std::snprintf(login.password, sizeof(login.password), "pw");
+            login.wireFormat = WIRE_FORMAT_DEFAULT;
+            co_await asio::async_write(socket_, asio::buffer(&login, sizeof(login)), asio::redirect_error(asio::use_awaitable, ec));
+            if (ec)
+            {
+                ++g_failed;
+                co_return;
+            }
+
+            // 수신 루프: 완성된 패킷만 처리하고 남은 조각은 앞으로 당긴다
+            std::size_t filled = 0;
+            for (;;)
+            {
+                const std::size_t bytes = co_await socket_.async_read_some(
+                    asio::buffer(recv_buffer_.data() + filled, recv_buffer_.size() - filled),
+                    asio::redirect_error(asio::use_awaitable, ec));
+                if (ec || bytes == 0)
+                    break;
+                filled += bytes;
+
+                std::size_t offset = 0;
+                while (filled - offset >= sizeof(PACKET_HEADER))
+                {
+                    PACKET_HEADER header;
+                    std::memcpy(&header, recv_buffer_.data() + offset, sizeof(header));
+                    if (header.pkt_size < sizeof(PACKET_HEADER) || header.pkt_size > recv_buffer_.size())
+                    {
+                        std::fprintf(stderr, "%s: invalid packet size %u\n", name_.c_str(), static_cast<unsigned int>(header.pkt_size));
+                        co_return;
+                    }
+                    if (filled - offset < header.pkt_size)
+                        break;
+
+                    HandlePacket(header, recv_buffer_.data() + offset);
+                    offset += header.pkt_size;
+                }
+                std::memmove(recv_buffer_.data(), recv_buffer_.data() + offset, filled - offset);
+                filled -= offset;
+            }
+
+            if (logged_in_)
+                std::fprintf(stderr, "%s: disconnected (%s)\n", name_.c_str(), ec.message().c_str());
+            else
+                ++g_failed;
+            ping_timer_.cancel();
+        }
+
+        void HandlePacket(const PACKET_HEADER& header, const char* data)
+        {
+            if (header.pkt_id == RES_LOGIN && header.pkt_size >= sizeof(PKT_RES_LOGIN))
+            {
+                PKT_RES_LOGIN response;
+                std::memcpy(&response, data, sizeof(response));
+                if (!response.isSuccess)
+                {
+                    ++g_failed;
+                    return;
+                }
+
+                logged_in_ = true;
+                ++g_logged_in;
+                asio::co_spawn(socket_.get_executor(), PingLoop(shared_from_this()), asio::detached);
+                return;
+            }
+
+            // 자기 자신에게 보낸 귓속말: 메시지가 보낸 시각 (8바이트)
+            if (header.pkt_id == NOTICE_CHAT && header.pkt_size >= sizeof(PACKET_HEADER) + 3)
+            {
+                const auto& notice = *reinterpret_cast<const PKT_NOTICE_CHAT*>(data);
+                if (notice.channel != CHAT_CHANNEL_WHISPER || notice.messageLen != sizeof(std::int64_t))
+                    return;
+
+                std::int64_t sent_ns;
+                std::memcpy(&sent_ns, notice.text + notice.senderNameLen, sizeof(sent_ns));
+                if (sent_ns != outstanding_ns_)
+                    return;
+
+                outstanding_ns_ = 0;
+                if (g_measuring.load(std::memory_order_relaxed))
+                    stats_.latencies_us.push_back(static_cast<std::uint32_t>((NowNs() - sent_ns) / 1000));
+            }
+        }
+
+        asio::awaitable<void> PingLoop(std::shared_ptr<BenchClient> self)
+        {
+            const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / config_.ping_hz));
+
+            // 세션마다 위상을 흩어서 한 순간에 몰리지 않게
+            Clock::time_point next = Clock::now() + period * static_cast<long>((index_ * 2654435761u) % 1000) / 1000;
+
+            PKT_REQ_CHAT ping{};
+            ping.pkt_id = REQ_CHAT;
+            ping.pkt_size = static_cast<std::uint16_t>(sizeof(PACKET_HEADER) + 1 + MAX_NAME_LEN + 1 + sizeof(std::int64_t));
+            ping.channel = CHAT_CHANNEL_WHISPER;
+            std::snprintf(ping.targetName, sizeof(ping.targetName), "%s", name_.c_str());
+            ping.messageLen = sizeof(std::int64_t);
+
+            error_code ec;
+            while (socket_.is_open())
+            {
+                ping_timer_.expires_at(next);
+                co_await ping_timer_.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+                if (ec)
+                    break;
+                next += period;
+
+                const bool measuring = g_measuring.load(std::memory_order_relaxed);
+                if (outstanding_ns_ != 0)
+                {
+                    if (measuring)
+                        ++stats_.skipped;
+                    continue;
+                }
+
+                outstanding_ns_ = NowNs();
+                std::memcpy(ping.message, &outstanding_ns_, sizeof(outstanding_ns_));
+                if (measuring)
+                    ++stats_.pings_sent;
+
+                co_await asio::async_write(socket_, asio::buffer(&ping, ping.pkt_size), asio::redirect_error(asio::use_awaitable, ec));
+                if (ec)
+                    break;
+            }
+        }
+
+        tcp::socket socket_;
+        asio::steady_timer ping_timer_;
+        ThreadStats& stats_;
+        const BenchConfig& config_;
+        std::string name_;
+        std::size_t index_;
+
+        std::vector<char> recv_buffer_;
+        std::int64_t outstanding_ns_ = 0; // 응답을 기다리는 핑의 보낸 시각 (0이면 없음)
+        bool logged_in_ = false;
+    };
+
+    std::uint32_t Percentile(const std::vector<std::uint32_t>& sorted, double q)
+    {
+        if (sorted.empty())
+            return 0;
+        const std::size_t index = std::min(sorted.size() - 1, static_cast<std::size_t>(q * static_cast<double>(sorted.size())));
+        return sorted[index];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const BenchConfig config = BenchConfig::FromArgs(argc, argv);
+
+    std::vector<std::unique_ptr<asio::io_context>> io_contexts;
+    std::vector<asio::executor_work_guard<asio::io_context::executor_type>> work_guards;
+    std::vector<ThreadStats> stats(config.threads);
+    for (std::size_t i = 0; i < config.threads; ++i)
+    {
+        io_contexts.push_back(std::make_unique<asio::io_context>(1));
+        work_guards.push_back(asio::make_work_guard(*io_contexts.back()));
+        stats[i].latencies_us.reserve(static_cast<std::size_t>(
+            config.ping_hz * config.duration_sec * static_cast<double>(config.sessions) / static_cast<double>(config.threads) * 1.1));
+    }
+
+    const tcp::endpoint endpoint(asio::ip::make_address(config.host), config.port);
+    for (std::size_t i = 0; i < config.sessions; ++i)
+    {
+        const auto delay = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(i) / config.connect_rate));
+        const std::size_t shard = i % config.threads;
+        std::make_shared<BenchClient>(*io_contexts[shard], stats[shard], config, i)->Start(endpoint, delay);
+    }
+
+    std::vector<std::thread> threads;
+    for (auto& io_context : io_contexts)
+        threads.emplace_back([&io_context]() { io_context->run(); });
+
+    // 전원 로그인(또는 실패)할 때까지 대기
+    const auto connect_deadline = Clock::now() +
+        std::chrono::seconds(static_cast<long>(static_cast<double>(config.sessions) / config.connect_rate) + 30);
+    while (g_logged_in.load() + g_failed.load() < config.sessions && Clock::now() < connect_deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::printf("READY sessions=%zu failed=%zu\n", g_logged_in.load(), g_failed.load());
+    std::fflush(stdout);
+
+    std::this_thread::sleep_for(std::chrono::seconds(config.warmup_sec));
+    std::printf("MEASURE_BEGIN\n");
+    std::fflush(stdout);
+    g_measuring.store(true);
+    std::this_thread::sleep_for(std::chrono::seconds(config.duration_sec));
+    g_measuring.store(false);
+
+    // 통계는 각 쓰레드에서 꺼내 온다 (측정 플래그를 늦게 본 핸들러와 겹치지 않도록)
+    std::vector<std::uint32_t> latencies;
+    std::uint64_t pings_sent = 0;
+    std::uint64_t skipped = 0;
+    for (std::size_t i = 0; i < config.threads; ++i)
+    {
+        std::promise<void> done;
+        asio::post(*io_contexts[i], [&]()
+            {
+                latencies.insert(latencies.end(), stats[i].latencies_us.begin(), stats[i].latencies_us.end());
+                pings_sent += stats[i].pings_sent;
+                skipped += stats[i].skipped;
+                done.set_value();
+            });
+        done.get_future().wait();
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::printf("RESULT sessions=%zu duration_sec=%u pings=%llu pongs=%zu skipped=%llu p50_us=%u p99_us=%u p999_us=%u max_us=%u\n",
+        g_logged_in.load(), config.duration_sec,
+        static_cast<unsigned long long>(pings_sent), latencies.size(), static_cast<unsigned long long>(skipped),
+        Percentile(latencies, 0.50), Percentile(latencies, 0.99), Percentile(latencies, 0.999),
+        latencies.empty() ? 0u : latencies.back());
+    std::fflush(stdout);
+
+    if (config.hold_sec != 0)
+    {
+        std::printf("HOLD_BEGIN\n");
+        std::fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::seconds(config.hold_sec));
+    }
+
+    for (auto& io_context : io_contexts)
+        io_context->stop();
+    for (auto& thread : threads)
+        thread.join();
+    return 0;
+}
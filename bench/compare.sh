@@ -0,0 +1,98 @@
+#!/usr/bin/env bash
+# epoll / io_uring 빌드를 같은 머신에서 같은 부하로 돌려 비교
+# - 지연: FixerBench의 귓속말 왕복 p50/p99/p999 (측정 구간 동안)
+# - CPU: 같은 구간의 서버 utime+stime, 세션 1만 개당 코어 수로 환산
+# - syscall: 측정이 끝난 뒤 hold 구간에서 perf(없으면 strace)로 센다 (추적 비용이 지연 측정에 섞이지 않도록)
+#
+# 사용법: bench/compare.sh [세션 수] [측정 초] [추가 FixerServer 인자...]
+# 환경 변수: BENCH_BUILD_ROOT(빌드 위치), BENCH_THREADS(클라이언트 쓰레드), BENCH_PING_HZ, BENCH_BACKENDS("epoll io_uring")
+set -euo pipefail
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+SESSIONS=${1:-10000}
+DURATION=${2:-30}
+shift $(( $# < 2 ? $# : 2 ))
+SERVER_ARGS=("$@")
+
+BUILD_ROOT=${BENCH_BUILD_ROOT:-$ROOT/_bench}
+CLIENT_THREADS=${BENCH_THREADS:-4}
+PING_HZ=${BENCH_PING_HZ:-1}
+BACKENDS=${BENCH_BACKENDS:-"epoll io_uring"}
+WARMUP=5
+HOLD=10
+CLK_TCK=$(getconf CLK_TCK)
+
+# 세션 수 x 2(서버 + 클라이언트)만큼 fd가 필요
+ulimit -n $(( SESSIONS * 2 + 1024 )) 2>/dev/null || echo "warning: could not raise open file limit ($(ulimit -n))" >&2
+
+cpu_ticks() { awk '{ print $14 + $15 }' "/proc/$1/stat"; }
+
+# $1=pid $2=초 -> 초당 syscall 수 (도구가 없으면 n/a)
+count_syscalls() {
+    local pid=$1 seconds=$2 total
+    if command -v perf >/dev/null 2>&1; then
+        total=$(perf stat -x, -e raw_syscalls:sys_enter -p "$pid" -- sleep "$seconds" 2>&1 >/dev/null | awk -F, '/raw_syscalls/ { print $1 }')
+    elif command -v strace >/dev/null 2>&1; then
+        total=$(timeout -s INT "$seconds" strace -c -f -p "$pid" 2>&1 >/dev/null | awk '$NF == "total" { print $4 }')
+    fi
+    if [[ -n "${total:-}" && "$total" =~ ^[0-9]+$ ]]; then
+        echo $(( total / seconds ))
+    else
+        echo "n/a"
+    fi
+}
+
+wait_for_line() { # $1=파일 $2=패턴 $3=bench pid
+    until grep -q "$2" "$1"; do
+        kill -0 "$3" 2>/dev/null || { echo "FixerBench exited early:" >&2; cat "$1" >&2; return 1; }
+        sleep 0.1
+    done
+}
+
+mkdir -p "$BUILD_ROOT"
+results=()
+for backend in $BACKENDS; do
+    build=$BUILD_ROOT/$backend
+    use_uring=OFF
+    [[ $backend == io_uring ]] && use_uring=ON
+
+    echo "== $backend: building in $build"
+    if ! cmake -S "$ROOT" -B "$build" -DCMAKE_BUILD_TYPE=Release -DFIXER_BUILD_BENCH=ON -DFIXER_USE_IO_URING=$use_uring >"$build.cmake.log" 2>&1 \
+        || ! cmake --build "$build" -j"$(nproc)" >>"$build.cmake.log" 2>&1; then
+        echo "   build failed, skipped (see $build.cmake.log)"
+        results+=("$(printf '%-9s %s' "$backend" 'build failed')")
+        continue
+    fi
+
+    "$build/FixerServer" --log-level warn "${SERVER_ARGS[@]}" >"$build.server.log" 2>&1 &
+    server=$!
+    sleep 1
+
+    "$build/FixerBench" --sessions "$SESSIONS" --threads "$CLIENT_THREADS" --ping-hz "$PING_HZ" \
+        --warmup-sec $WARMUP --duration-sec "$DURATION" --hold-sec $HOLD >"$build.bench.log" 2>"$build.bench.err" &
+    bench=$!
+
+    wait_for_line "$build.bench.log" '^MEASURE_BEGIN' $bench
+    cpu_begin=$(cpu_ticks $server)
+    wait_for_line "$build.bench.log" '^RESULT' $bench
+    cpu_end=$(cpu_ticks $server)
+    wait_for_line "$build.bench.log" '^HOLD_BEGIN' $bench
+    syscalls=$(count_syscalls $server $(( HOLD - 2 )))
+
+    wait $bench || true
+    kill $server 2>/dev/null; wait $server 2>/dev/null || true
+
+    result=$(grep '^RESULT' "$build.bench.log")
+    field() { sed -n "s/.* $1=\([0-9]*\).*/\1/p" <<<"$result"; }
+    sessions=$(field sessions)
+    cores_per_10k=$(awk -v t=$(( cpu_end - cpu_begin )) -v hz="$CLK_TCK" -v d="$DURATION" -v s="$sessions" \
+        'BEGIN { printf "%.3f", (s > 0) ? t / hz / d * 10000 / s : 0 }')
+
+    echo "   $result"
+    results+=("$(printf '%-9s %8s %8s %8s %8s %10s %12s' "$backend" "$sessions" \
+        "$(field p50_us)" "$(field p99_us)" "$(field p999_us)" "$cores_per_10k" "$syscalls")")
+done
+
+echo
+printf '%-9s %8s %8s %8s %8s %10s %12s\n' backend sessions p50_us p99_us p999_us cpu/10k syscalls/s
+printf '%s\n' "${results[@]}"
@@ -0,0 +1,80 @@
+﻿// 송신 큐가 소프트 한도를 넘은 세션도 AOI 스냅샷의 모든 조각을 받는지 확인
+// - Lobby(정원 > MAX_PLAYERS_PER_ROOM)는 AOI 방: 시야 안 20명은 16 + 4명 두 조각으로 나뉜다.
+// - 패킷 한도 1이면 두 조각이 함께 쌓일 때마다 한도를 넘으므로, 조각마다 순번이 다르면 앞 조각이 버려진다.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TestSupport.h"
+
+int main()
+{
+    Logger::Instance().SetMinLevel(LogLevel::Warn);
+
+    ServerConfig config;
+    config.send_queue_limits.max_packets = 1;
+    TestServer server(config);
+
+    constexpr int PLAYER_COUNT = 20;
+    std::vector<std::unique_ptr<TestClient>> clients;
+    for (int i = 0; i < PLAYER_COUNT; ++i)
+    {
+        clients.push_back(std::make_unique<TestClient>(server.GetPort()));
+        const std::string name = "aoi" + std::to_string(i);
+        TEST_CHECK(clients.back()->Login(name.c_str()));
+        TEST_CHECK(clients.back()->EnterRoom("Lobby"));
+    }
+
+    TestClient& observer = *clients[0];
+
+    // 모두 시야 반경 안에서 움직여 틱마다 스냅샷이 나가게 함 (snapshotSeq -> 받은 조각 비트)
+    struct Parts
+    {
+        std::uint8_t count = 0;
+        std::uint32_t received = 0;
+    };
+    std::map<std::uint32_t, Parts> snapshots;
+
+    auto on_packet = [&snapshots](const PACKET_HEADER& header)
+    {
+        if (header.pkt_id != NOTICE_PLAYER_STATE)
+            return;
+
+        const auto& pkt = *reinterpret_cast<const PKT_NOTICE_PLAYER_STATE*>(&header);
+        const PlayerStateSnapshotInfo info = ReadPlayerStateInfo(pkt);
+        TEST_CHECK(info.partIndex < info.partCount);
+
+        Parts& parts = snapshots[info.snapshotSeq];
+        parts.count = info.partCount;
+        parts.received |= 1u << info.partIndex;
+    };
+
+    for (int round = 0; round < 40; ++round)
+    {
+        for (int i = 1; i < PLAYER_COUNT; ++i)
+            clients[i]->SendState(static_cast<float>(i), static_cast<float>(round % 8));
+
+        observer.ReceiveFor(std::chrono::milliseconds(20), on_packet);
+    }
+
+    // 마지막 스냅샷의 나머지 조각까지
+    observer.ReceiveFor(std::chrono::milliseconds(200), on_packet);
+
+    // 받은 스냅샷은 전부 완전해야 한다 (통째로 건너뛴 스냅샷은 괜찮음)
+    int multi_part = 0;
+    for (const auto& [seq, parts] : snapshots)
+    {
+        const std::uint32_t all = (1u << parts.count) - 1;
+        if (parts.received != all)
+            std::fprintf(stderr, "snapshot %u: parts 0x%x of %u\n", seq, parts.received, parts.count);
+        TEST_CHECK(parts.received == all);
+        if (parts.count > 1)
+            ++multi_part;
+    }
+    TEST_CHECK(multi_part >= 5);
+
+    clients.clear();
+    return TestResult("AoiSnapshotTest");
+}
@@ -0,0 +1,114 @@
+﻿// 좌표 양자화 + 비트 패킹 왕복: 임의 좌표를 양자화 -> BitWriter -> BitReader -> 역양자화했을 때
+// 오차가 양자화 반 단계(+ float 반올림 여유) 이내인지 여러 비트 폭에서 확인
+// - BitWriter는 바이트 단위로 쓰므로, 비트 폭을 섞고 앞에 슬롯 비트를 두어 필드가 바이트 중간에서 시작해
+//   다음 바이트로 넘어가도록 한다 (그런 필드가 있었는지도 확인).
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "BitPacking.h"
+#include "TestSupport.h"
+
+namespace
+{
+    struct Field
+    {
+        float value;
+        std::uint32_t quantized;
+        unsigned int bits;
+        std::size_t bit_offset;
+    };
+
+    // 범위 [min, max]의 좌표 count개를 bits_list 폭으로 돌아가며 패킹 후 되읽어 확인,
+    // 바이트 중간에서 시작해 바이트 경계를 가로지른 필드 수 반환
+    int RoundTrip(std::mt19937& rng, float min, float max, const std::vector<unsigned int>& bits_list, int count)
+    {
+        std::uniform_real_distribution<float> coord(min, max);
+        std::vector<std::uint8_t> buffer(static_cast<std::size_t>(count) * 4 + 8, 0);
+
+        BitWriter writer(buffer.data(), buffer.size());
+        std::size_t bit_offset = 0;
+
+        // 슬롯 번호처럼 앞에 홀수 비트를 하나 두어 정렬을 흐트러뜨림
+        constexpr unsigned int LEAD_BITS = 5;
+        TEST_CHECK(writer.Write(0x15, LEAD_BITS));
+        bit_offset += LEAD_BITS;
+
+        std::vector<Field> fields;
+        for (int i = 0; i < count; ++i)
+        {
+            const unsigned int bits = bits_list[i % bits_list.size()];
+            // 범위 경계값도 섞음
+            const float value = (i % 97 == 0) ? min : (i % 89 == 0) ? max : coord(rng);
+            const std::uint32_t quantized = QuantizeCoord(value, min, max, bits);
+
+            TEST_CHECK(quantized <= (1u << bits) - 1);
+            TEST_CHECK(writer.Write(quantized, bits));
+            fields.push_back(Field{ value, quantized, bits, bit_offset });
+            bit_offset += bits;
+        }
+        TEST_CHECK(writer.BytesWritten() == (bit_offset + 7) / 8);
+
+        BitReader reader(buffer.data(), writer.BytesWritten());
+        std::uint32_t lead = 0;
+        TEST_CHECK(reader.Read(lead, LEAD_BITS));
+        TEST_CHECK(lead == 0x15);
+
+        // 양자화/역양자화의 float 연산 오차 (좌표 크기 기준 몇 ulp)
+        const float epsilon = 4.0f * std::numeric_limits<float>::epsilon() * std::max(std::abs(min), std::abs(max));
+
+        int crossing = 0;
+        for (const Field& field : fields)
+        {
+            std::uint32_t quantized = 0;
+            TEST_CHECK(reader.Read(quantized, field.bits));
+            TEST_CHECK(quantized == field.quantized);
+
+            const float restored = DequantizeCoord(quantized, min, max, field.bits);
+            const float max_error = QuantizationMaxError(min, max, field.bits) + epsilon;
+            const float error = restored > field.value ? restored - field.value : field.value - restored;
+            if (!(error <= max_error))
+            {
+                std::fprintf(stderr, "bits %u: %f -> %u -> %f (error %f, max %f)\n",
+                    field.bits, field.value, quantized, restored, error, max_error);
+            }
+            TEST_CHECK(error <= max_error);
+
+            if (field.bit_offset % 8 != 0 && field.bit_offset / 8 != (field.bit_offset + field.bits - 1) / 8)
+                ++crossing;
+        }
+
+        // 다 읽었으면 더 읽을 수 없어야 함 (바이트 끝 패딩보다 큰 폭)
+        std::uint32_t extra = 0;
+        TEST_CHECK(!reader.Read(extra, 8));
+        return crossing;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(12345);
+    constexpr QuantizationParams params{};
+
+    // 비트 폭마다 따로 (앞의 5비트 때문에 8의 배수 폭도 바이트 중간에서 시작)
+    for (const unsigned int bits : { 8u, 10u, 12u, 13u, 14u, 16u, 17u, 20u, 23u, 24u })
+        TEST_CHECK(RoundTrip(rng, params.min_x, params.max_x, { bits }, 1000) > 0);
+
+    // 폭을 섞어서 (x/y 축 폭이 다른 경우)
+    TEST_CHECK(RoundTrip(rng, params.min_x, params.max_x, { 14u, 11u, 19u, 7u }, 2000) > 0);
+
+    // 원점이 범위 밖인 비대칭 범위
+    TEST_CHECK(RoundTrip(rng, 100.0f, 612.5f, { 9u, 15u, 21u }, 2000) > 0);
+
+    // 용량 밖 쓰기는 거부
+    std::uint8_t small[2] = {};
+    BitWriter writer(small, sizeof(small));
+    TEST_CHECK(writer.Write(0x3FFF, 14));
+    TEST_CHECK(!writer.Write(0x7, 3));
+    TEST_CHECK(writer.BitsRemaining() == 2);
+
+    return TestResult("BitPackingTest");
+}
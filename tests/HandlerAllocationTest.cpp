@@ -0,0 +1,104 @@
+﻿// 워밍업 뒤 패킷 왕복마다 힙 할당이 0인지 확인
+// - 실제 서버에 로그인한 두 세션이 귓속말을 주고받는다: 수신 -> 디스패치 -> 유저/세션 조회 -> MakeSendBuffer
+//   -> 두 세션의 송신 큐 -> 쓰기까지 서버 쪽 경로 전체를 한 번씩 지난다.
+// - 전역 operator new를 바꿔서 측정 구간 동안 모든 쓰레드의 할당을 센다.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "TestSupport.h"
+
+namespace
+{
+    std::atomic<bool> g_counting{ false };
+    std::atomic<std::size_t> g_allocations{ 0 };
+
+    void* CountedAlloc(std::size_t size, std::size_t alignment)
+    {
+        if (g_counting.load(std::memory_order_relaxed))
+            g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+        if (size == 0)
+            size = 1;
+
+        void* pointer = alignment <= alignof(std::max_align_t)
+            ? std::malloc(size)
+            : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (!pointer)
+            throw std::bad_alloc();
+        return pointer;
+    }
+
+    PKT_REQ_CHAT MakeWhisper(const char* target, const char* text)
+    {
+        PKT_REQ_CHAT request{};
+        request.pkt_id = REQ_CHAT;
+        request.channel = CHAT_CHANNEL_WHISPER;
+        std::strncpy(request.targetName, target, MAX_NAME_LEN - 1);
+        request.messageLen = static_cast<std::uint8_t>(std::strlen(text));
+        std::memcpy(request.message, text, request.messageLen);
+        request.pkt_size = static_cast<std::uint16_t>(ReqChatSize(request.messageLen));
+        return request;
+    }
+}
+
+void* operator new(std::size_t size) { return CountedAlloc(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return CountedAlloc(size, static_cast<std::size_t>(alignment)); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+int main()
+{
+    // 부하 중 가끔 찍히는 경고 로그(늦은 틱 등)가 측정 구간에서 할당하지 않도록 Error만 남김
+    Logger::Instance().SetMinLevel(LogLevel::Error);
+
+    // 빈 방 정리/통계 타이머는 메시지와 상관없는 주기 작업이므로 측정 구간에 끼지 않게 미루거나 끔
+    ServerConfig config;
+    config.room_lifecycle.reap_grace = std::chrono::hours(1);
+    config.room_lifecycle.reap_check_interval = std::chrono::hours(1);
+    config.stats_report_interval = std::chrono::seconds(0);
+    TestServer server(config);
+
+    TestClient alice(server.GetPort());
+    TestClient bob(server.GetPort());
+    TEST_CHECK(alice.Login("alice"));
+    TEST_CHECK(bob.Login("bob"));
+
+    const PKT_REQ_CHAT whisper = MakeWhisper("bob", "ping");
+    alignas(8) char buffer[MAX_RECEIVE_BUFFER_LEN];
+
+    // 보낸 쪽과 받는 쪽 모두 NOTICE_CHAT 하나씩
+    auto round_trip = [&]()
+    {
+        alice.Send(whisper);
+        const bool to_bob = bob.Receive(buffer, sizeof(buffer)) &&
+            reinterpret_cast<const PACKET_HEADER*>(buffer)->pkt_id == NOTICE_CHAT;
+        const bool to_alice = alice.Receive(buffer, sizeof(buffer)) &&
+            reinterpret_cast<const PACKET_HEADER*>(buffer)->pkt_id == NOTICE_CHAT;
+        return to_bob && to_alice;
+    };
+
+    // 워밍업: 노드/송신 버퍼 캐시, 핸들러 메모리가 채워질 때까지
+    constexpr int WARMUP_MESSAGES = 1000;
+    constexpr int MEASURED_MESSAGES = 10000;
+    bool received_all = true;
+    for (int i = 0; i < WARMUP_MESSAGES; ++i)
+        received_all = round_trip() && received_all;
+
+    g_counting.store(true);
+    for (int i = 0; i < MEASURED_MESSAGES; ++i)
+        received_all = round_trip() && received_all;
+    g_counting.store(false);
+
+    const std::size_t allocations = g_allocations.load();
+    if (allocations != 0)
+        std::fprintf(stderr, "%zu allocations over %d messages\n", allocations, MEASURED_MESSAGES);
+
+    TEST_CHECK(received_all);
+    TEST_CHECK(allocations == 0);
+
+    return TestResult("HandlerAllocationTest");
+}
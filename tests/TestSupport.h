@@ -0,0 +1,189 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <boost/asio.hpp>
+
+#include "GameServer.h"
+#include "IoContextPool.h"
+#include "ServerConfig.h"
+#include "Protocol.h"
+#include "Logger.h"
+
+// ===== 테스트 공용 =====
+// - 프레임워크 없이 실행 파일 하나가 테스트 하나: TEST_CHECK가 실패를 세고 main이 TestResult()를 반환한다.
+// - TestServer는 I/O 샤드 하나 + OS가 배정한 포트로 실제 GameServer를 띄운다.
+// - TestClient는 블로킹 소켓 클라이언트 (테스트 쓰레드에서만 사용).
+
+inline int g_test_failures = 0;
+
+#define TEST_CHECK(condition)                                                              \
+    do                                                                                     \
+    {                                                                                      \
+        if (!(condition))                                                                  \
+        {                                                                                  \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++g_test_failures;                                                             \
+        }                                                                                  \
+    } while (0)
+
+// main 끝에서 반환 (로거 쓰레드를 정리하고 결과 출력)
+inline int TestResult(const char* name)
+{
+    Logger::Instance().Shutdown();
+    std::printf("%s: %s (%d failed checks)\n", name, g_test_failures == 0 ? "PASS" : "FAIL", g_test_failures);
+    return g_test_failures == 0 ? 0 : 1;
+}
+
+class TestServer
+{
+public:
+    explicit TestServer(ServerConfig config = ServerConfig{})
+        : io_pool_(1)
+        , server_(io_pool_, ForTest(config))
+        , thread_([this]() { io_pool_.Run(); })
+    {
+    }
+
+    ~TestServer()
+    {
+        server_.Stop();
+        thread_.join();
+    }
+
+    TestServer(const TestServer&) = delete;
+    TestServer& operator=(const TestServer&) = delete;
+
+    GameServer& Get() { return server_; }
+    IoContextPool& GetIoPool() { return io_pool_; }
+    std::uint16_t GetPort() const { return server_.GetPort(); }
+
+private:
+    static ServerConfig ForTest(ServerConfig config)
+    {
+        config.port = 0;
+        config.io_thread_count = 1;
+        return config;
+    }
+
+    IoContextPool io_pool_;
+    GameServer server_;
+    std::thread thread_;
+};
+
+class TestClient
+{
+public:
+    using tcp = boost::asio::ip::tcp;
+
+    explicit TestClient(std::uint16_t port)
+        : socket_(io_context_)
+    {
+        socket_.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+        socket_.set_option(tcp::no_delay(true));
+    }
+
+    tcp::socket& GetSocket() { return socket_; }
+
+    template <typename Packet>
+    void Send(const Packet& packet)
+    {
+        boost::asio::write(socket_, boost::asio::buffer(&packet, packet.pkt_size));
+    }
+
+    // 패킷 하나를 끝까지 받음 (블록), 크기가 버퍼를 넘으면 false
+    bool Receive(char* buffer, std::size_t capacity)
+    {
+        boost::asio::read(socket_, boost::asio::buffer(buffer, sizeof(PACKET_HEADER)));
+        const auto* header = reinterpret_cast<const PACKET_HEADER*>(buffer);
+        if (header->pkt_size < sizeof(PACKET_HEADER) || header->pkt_size > capacity)
+            return false;
+
+        boost::asio::read(socket_, boost::asio::buffer(buffer + sizeof(PACKET_HEADER), header->pkt_size - sizeof(PACKET_HEADER)));
+        return true;
+    }
+
+    // duration 동안 도착하는 패킷마다 fn(const PACKET_HEADER&) 호출
+    template <typename Fn>
+    void ReceiveFor(std::chrono::milliseconds duration, Fn&& fn)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            if (socket_.available() < sizeof(PACKET_HEADER))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+
+            if (!Receive(buffer_, sizeof(buffer_)))
+                return;
+            fn(*reinterpret_cast<const PACKET_HEADER*>(buffer_));
+        }
+    }
+
+    // pkt_id 패킷이 올 때까지 받음 (그 사이 패킷은 버림), 시간 안에 못 받으면 nullptr
+    const PACKET_HEADER* WaitFor(PACKET_ID pkt_id, std::chrono::milliseconds timeout = std::chrono::seconds(2))
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            if (socket_.available() < sizeof(PACKET_HEADER))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+
+            if (!Receive(buffer_, sizeof(buffer_)))
+                return nullptr;
+
+            const auto* header = reinterpret_cast<const PACKET_HEADER*>(buffer_);
+            if (header->pkt_id == pkt_id)
+                return header;
+        }
+        return nullptr;
+    }
+
+    bool Login(const char* name, WIRE_FORMAT format = WIRE_FORMAT_DEFAULT)
+    {
+        PKT_REQ_LOGIN request{};
+        request.pkt_id = REQ_LOGIN;
+        request.pkt_size = sizeof(request);
+        std::strncpy(request.userId, name, MAX_ID_LEN - 1);
+        std::strncpy(request.password, "test", MAX_PW_LEN - 1);
+        request.wireFormat = format;
+        Send(request);
+
+        const auto* response = reinterpret_cast<const PKT_RES_LOGIN*>(WaitFor(RES_LOGIN));
+        return response && response->isSuccess;
+    }
+
+    bool EnterRoom(const char* room_name)
+    {
+        PKT_REQ_ENTER_ROOM request{};
+        request.pkt_id = REQ_ENTER_ROOM;
+        request.pkt_size = sizeof(request);
+        std::strncpy(request.roomName, room_name, MAX_ROOM_NAME_LEN - 1);
+        Send(request);
+
+        const auto* response = reinterpret_cast<const PKT_RES_ENTER_ROOM*>(WaitFor(RES_ENTER_ROOM));
+        return response && response->isSuccess;
+    }
+
+    void SendState(float x, float y)
+    {
+        PKT_REQ_PLAYER_STATE request{};
+        request.pkt_id = REQ_PLAYER_STATE;
+        request.pkt_size = sizeof(request);
+        request.characterState = CharacterState{ x, y };
+        Send(request);
+    }
+
+private:
+    boost::asio::io_context io_context_;
+    tcp::socket socket_;
+    alignas(8) char buffer_[MAX_RECEIVE_BUFFER_LEN];
+};